@@ -0,0 +1,271 @@
+/*
+ * Microbenchmarks for every libsysres entry point.
+ *
+ * Usage: sysres_bench [-n iterations] [root ...]
+ *
+ * Each root is passed to sysres_set_root() ("/" means the live
+ * filesystem), so the same run covers the live host and the fixture trees
+ * in test/fixtures/. Each root also reports the CPU load, CPU limit and
+ * memory limit read under it, to show which tree the rows measured.
+ * Results are printed as JSON on stdout:
+ *
+ *   median_ns / p99_ns   per-call latency (CLOCK_MONOTONIC)
+ *   source_reads         source reads per call (sysres_get_stats)
+ *   syscalls             syscalls per call, as counted by the library
+ *   read_syscalls        read(2)-family syscalls per call (/proc/self/io),
+ *                        an independent check on the library's count
+ *   allocs / alloc_bytes heap allocations per call (malloc interposition)
+ *
+ * Linux/glibc only: it relies on __libc_malloc.
+ */
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sysres.h"
+
+/* -------------------------------------------------------------------------
+ * Accounting
+ * ------------------------------------------------------------------------- */
+
+static long long alloc_count = 0;
+static long long alloc_bytes = 0;
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+/* Interposes glibc's allocator for the whole process */
+void *malloc(size_t size)
+{
+	alloc_count++;
+	alloc_bytes += (long long)size;
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+	alloc_count++;
+	alloc_bytes += (long long)(count * size);
+	return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+	alloc_count++;
+	alloc_bytes += (long long)size;
+	return __libc_realloc(ptr, size);
+}
+
+/* Read-family syscalls issued by this process so far ("syscr") */
+static long long read_syscalls()
+{
+	char buff[512] = {0};
+	int fd = open("/proc/self/io", O_RDONLY);
+	if (fd < 0)
+	{
+		return -1;
+	}
+	ssize_t len = read(fd, buff, sizeof(buff) - 1);
+	close(fd);
+	if (len <= 0)
+	{
+		return -1;
+	}
+
+	char *hit = strstr(buff, "syscr:");
+	return hit == NULL ? -1 : strtoll(hit + 6, NULL, 10);
+}
+
+static long long now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* Source reads and syscalls from the library's own counters */
+static void library_reads(long long *reads, long long *syscalls)
+{
+	struct sysres_stats stats;
+	sysres_get_stats(&stats);
+
+	*reads = 0;
+	*syscalls = 0;
+	for (int i = 0; i < SYSRES_SOURCE_COUNT; i++)
+	{
+		*reads += stats.sources[i].reads;
+		*syscalls += stats.sources[i].syscalls;
+	}
+}
+
+static int compare_ll(const void *a, const void *b)
+{
+	long long x = *(const long long *)a;
+	long long y = *(const long long *)b;
+	return (x > y) - (x < y);
+}
+
+/* -------------------------------------------------------------------------
+ * Benchmarks
+ * ------------------------------------------------------------------------- */
+
+/* Results are accumulated here so calls cannot be optimized away */
+static volatile double sink = 0;
+
+static void bench_cpu_load() { sink += get_cpu_load(); }
+static void bench_cpu_limit_cores() { sink += get_cpu_limit_cores(); }
+static void bench_memory_usage() { sink += get_memory_usage(); }
+static void bench_memory_limit_bytes() { sink += (double)get_memory_limit_bytes(); }
+static void bench_memory_used_bytes() { sink += (double)get_memory_used_bytes(); }
+static void bench_is_container_env() { sink += is_container_env(); }
+
+static void bench_numa_nodes()
+{
+	struct sysres_numa_node nodes[8];
+	sink += get_numa_nodes(nodes, 8);
+}
+
+/* One read(2) per open counter group; opened on first use */
+static void bench_perf_read()
+{
+	static int opened = 0;
+	if (!opened)
+	{
+		sysres_perf_open();
+		opened = 1;
+	}
+	struct sysres_perf_counters counters;
+	sink += sysres_perf_read(&counters);
+}
+
+/* Limit lookup after a hotplug/resize notification (cache miss path) */
+static void bench_cpu_limit_cores_invalidated()
+{
+	sysres_invalidate_limits();
+	sink += get_cpu_limit_cores();
+}
+
+/* Everything a sampler tick reads */
+static void bench_snapshot()
+{
+	sink += get_cpu_load();
+	sink += get_cpu_limit_cores();
+	sink += (double)get_memory_limit_bytes();
+	sink += (double)get_memory_used_bytes();
+}
+
+struct benchmark
+{
+	const char *name;
+	void (*run)();
+};
+
+static const struct benchmark benchmarks[] = {
+	{"get_cpu_load", bench_cpu_load},
+	{"get_cpu_limit_cores", bench_cpu_limit_cores},
+	{"get_cpu_limit_cores_invalidated", bench_cpu_limit_cores_invalidated},
+	{"get_memory_usage", bench_memory_usage},
+	{"get_memory_limit_bytes", bench_memory_limit_bytes},
+	{"get_memory_used_bytes", bench_memory_used_bytes},
+	{"is_container_env", bench_is_container_env},
+	{"get_numa_nodes", bench_numa_nodes},
+	{"sysres_perf_read", bench_perf_read},
+	{"snapshot", bench_snapshot},
+};
+
+static void run_benchmark(const struct benchmark *bench, int iterations, long long *samples, int last)
+{
+	/* Warm up caches and the backend selection */
+	for (int i = 0; i < iterations / 10 + 1; i++)
+	{
+		bench->run();
+	}
+
+	long long sources_before, syscalls_before;
+	library_reads(&sources_before, &syscalls_before);
+	long long allocs_before = alloc_count;
+	long long bytes_before = alloc_bytes;
+	long long reads_before = read_syscalls();
+
+	for (int i = 0; i < iterations; i++)
+	{
+		long long start = now_ns();
+		bench->run();
+		samples[i] = now_ns() - start;
+	}
+
+	/* The second /proc/self/io read is one read syscall of our own */
+	long long reads = read_syscalls() - reads_before - 1;
+	double n = (double)iterations;
+	long long sources_after, syscalls_after;
+	library_reads(&sources_after, &syscalls_after);
+	double source_reads = (sources_after - sources_before) / n;
+	double syscalls = (syscalls_after - syscalls_before) / n;
+	double allocs = (alloc_count - allocs_before) / n;
+	double bytes = (alloc_bytes - bytes_before) / n;
+
+	/* Sort after taking the counters: qsort may allocate */
+	qsort(samples, (size_t)iterations, sizeof(long long), compare_ll);
+	long long median = samples[iterations / 2];
+	long long p99 = samples[(int)((iterations - 1) * 0.99)];
+
+	printf("        {\"name\": \"%s\", \"iterations\": %d, \"median_ns\": %lld, \"p99_ns\": %lld, "
+		   "\"source_reads\": %.2f, \"syscalls\": %.2f, \"read_syscalls\": %.2f, \"allocs\": %.2f, \"alloc_bytes\": %.1f}%s\n",
+		   bench->name, iterations, median, p99, source_reads, syscalls,
+		   reads_before < 0 ? -1.0 : reads / n, allocs, bytes,
+		   last ? "" : ",");
+}
+
+int main(int argc, char **argv)
+{
+	int iterations = 20000;
+	int first_root = 1;
+	if (argc > 2 && strcmp(argv[1], "-n") == 0)
+	{
+		iterations = atoi(argv[2]);
+		first_root = 3;
+	}
+	if (iterations <= 0)
+	{
+		fprintf(stderr, "iterations must be positive\n");
+		return 1;
+	}
+
+	static const char *live[] = {"/"};
+	const char **roots = first_root < argc ? (const char **)&argv[first_root] : live;
+	int root_count = first_root < argc ? argc - first_root : 1;
+
+	long long *samples = __libc_malloc(sizeof(long long) * (size_t)iterations);
+	if (samples == NULL)
+	{
+		return 1;
+	}
+
+	size_t count = sizeof(benchmarks) / sizeof(benchmarks[0]);
+	printf("{\n  \"iterations\": %d,\n  \"roots\": [\n", iterations);
+	for (int r = 0; r < root_count; r++)
+	{
+		sysres_set_root(roots[r]);
+		printf("    {\n      \"root\": \"%s\",\n      \"container\": %d,\n"
+			   "      \"values\": {\"cpu_load\": %.3f, \"cpu_limit_cores\": %.2f, \"memory_limit_bytes\": %lld},\n"
+			   "      \"results\": [\n",
+			   roots[r], is_container_env(), get_cpu_load(), get_cpu_limit_cores(),
+			   get_memory_limit_bytes());
+		for (size_t b = 0; b < count; b++)
+		{
+			run_benchmark(&benchmarks[b], iterations, samples, b == count - 1);
+		}
+		printf("      ]\n    }%s\n", r == root_count - 1 ? "" : ",");
+	}
+	printf("  ]\n}\n");
+
+	free(samples);
+	return 0;
+}
@@ -0,0 +1,202 @@
+/// Checks that reported CPU and memory track a known, generated load.
+///
+/// Usage: `dart run benchmark/accuracy.dart [options]`
+///
+/// - `--threads=N` isolates busy-looping (default 1)
+/// - `--duty=F` fraction of each 10 ms period they spin (default 0.5)
+/// - `--seconds=S` how long each phase runs (default 5)
+/// - `--memory-mb=M` block allocated and touched (default 256)
+/// - `--tolerance=F` relative error that passes (default 0.1)
+/// - `--fixture` simulate the load on a copy of `test/fixtures/cgroup-v2`
+///
+/// By default the load is real and measured through the process's own
+/// cgroup (or `/proc` on a host), with `/proc/self/stat` and RSS as the
+/// ground truth. `--fixture` is for machines where the process's cgroup
+/// cannot be used; it advances the fixture's counters instead.
+///
+/// For each phase it reports the target, the reference, the library's
+/// reading, the error and how long the library took to see the change.
+/// Exits with 1 if an error exceeds the tolerance or the change was never
+/// detected.
+library;
+
+import 'dart:async';
+import 'dart:io';
+
+import 'package:system_resources_2/src/platform_detector.dart';
+import 'package:system_resources_2/src/resource_backend.dart';
+import 'package:system_resources_2/system_resources_2.dart';
+
+import 'src/load_generators.dart';
+
+/// Result of one phase. [detectMicros] is `null` if the reading never
+/// came within tolerance of [reference].
+typedef _Result = ({
+  String name,
+  String unit,
+  num target,
+  num reference,
+  num measured,
+  int? detectMicros,
+});
+
+Future<void> main(List<String> args) async {
+  final options = {
+    for (final arg in args)
+      if (arg.startsWith('--'))
+        arg.substring(2).split('=').first: arg.contains('=')
+            ? arg.substring(arg.indexOf('=') + 1)
+            : 'true',
+  };
+  final threads = int.parse(options['threads'] ?? '1');
+  final duty = double.parse(options['duty'] ?? '0.5');
+  final seconds = int.parse(options['seconds'] ?? '5');
+  final memoryBytes = int.parse(options['memory-mb'] ?? '256') << 20;
+  final tolerance = double.parse(options['tolerance'] ?? '0.1');
+  final fixture = options['fixture'] == 'true';
+  if (threads < 1 || duty <= 0 || duty > 1 || seconds < 1) {
+    throw ArgumentError('Need threads >= 1, 0 < duty <= 1 and seconds >= 1');
+  }
+
+  Directory? root;
+  if (fixture) {
+    root = Directory.systemTemp.createTempSync('sysres_accuracy');
+    _copyTree(Directory('test/fixtures/cgroup-v2'), root);
+    PlatformDetector.setRoot(root.path);
+  }
+  SystemResources.clearState();
+  await SystemResources.init();
+
+  final rootPath = PlatformDetector.root;
+  print('root: ${rootPath.isEmpty ? '/' : rootPath}');
+  print('backend: ${ResourceBackend.current.runtimeType}');
+  print('container: ${SystemResources.isContainerEnv()}');
+
+  final duration = Duration(seconds: seconds);
+  final results = [
+    await _cpuPhase(threads, duty, duration, tolerance, fixture),
+    await _memoryPhase(memoryBytes, duration, tolerance, fixture),
+  ];
+
+  var failed = false;
+  for (final result in results) {
+    final error = result.measured - result.reference;
+    final relative = result.reference == 0 ? 0 : error / result.reference;
+    final detect = result.detectMicros;
+    failed |= detect == null || relative.abs() > tolerance;
+    print('${result.name}: target ${result.target}${result.unit}, '
+        'reference ${result.reference}${result.unit}, '
+        'measured ${result.measured}${result.unit}, '
+        'error ${error.round()}${result.unit} '
+        '(${(relative * 100).toStringAsFixed(1)}%), '
+        'detected ${detect == null ? 'never' : 'after ${detect ~/ 1000} ms'}');
+  }
+
+  if (root != null) {
+    PlatformDetector.setRoot(null);
+    root.deleteSync(recursive: true);
+  }
+  exit(failed ? 1 : 0);
+}
+
+/// Burns [threads] x [duty] cores and compares `cpuUsageMillicores()`
+/// (above the idle baseline) with the CPU time the process consumed.
+Future<_Result> _cpuPhase(int threads, double duty, Duration duration,
+    double tolerance, bool fixture) async {
+  const poll = Duration(milliseconds: 250);
+
+  SystemResources.cpuUsageMillicores();
+  await Future<void>.delayed(const Duration(seconds: 1));
+  final idle = SystemResources.cpuUsageMillicores();
+
+  final generator = CpuLoadGenerator(threads, duty);
+  final target = generator.targetMillicores;
+  final simulated = fixture ? (FixtureLoad(target)..start()) : null;
+  if (!fixture) await generator.start();
+
+  final clock = Stopwatch()..start();
+  final cpuBefore = processCpuMicros();
+  final readings = <int>[];
+  int? detectMicros;
+  while (clock.elapsed < duration) {
+    await Future<void>.delayed(poll);
+    final reading = SystemResources.cpuUsageMillicores() - idle;
+    if (detectMicros == null &&
+        (reading - target).abs() <= target * tolerance) {
+      detectMicros = clock.elapsedMicroseconds;
+    }
+    if (detectMicros != null) readings.add(reading);
+  }
+  final elapsed = clock.elapsedMicroseconds;
+  final cpuAfter = processCpuMicros();
+
+  generator.stop();
+  simulated?.stop();
+
+  final reference = fixture || cpuBefore < 0
+      ? target
+      : ((cpuAfter - cpuBefore) * 1000 / elapsed).round();
+  final measured = readings.isEmpty
+      ? 0
+      : (readings.reduce((a, b) => a + b) / readings.length).round();
+  return (
+    name: 'cpu',
+    unit: 'm',
+    target: target,
+    reference: reference,
+    measured: measured,
+    detectMicros: detectMicros,
+  );
+}
+
+/// Allocates and touches [bytes] and compares the growth of
+/// `memoryUsedBytes()` with the growth of the process RSS.
+Future<_Result> _memoryPhase(
+    int bytes, Duration duration, double tolerance, bool fixture) async {
+  const poll = Duration(milliseconds: 50);
+
+  final before = SystemResources.memoryUsedBytes();
+  final rssBefore = ProcessInfo.currentRss;
+  final generator = MemoryLoadGenerator(bytes);
+  final simulated = fixture ? (FixtureLoad(0)..start()) : null;
+
+  final clock = Stopwatch()..start();
+  if (fixture) {
+    simulated!.allocate(bytes);
+  } else {
+    generator.start();
+  }
+  final reference = fixture ? bytes : ProcessInfo.currentRss - rssBefore;
+
+  var measured = 0;
+  int? detectMicros;
+  while (clock.elapsed < duration) {
+    measured = SystemResources.memoryUsedBytes() - before;
+    if ((measured - reference).abs() <= reference * tolerance) {
+      detectMicros = clock.elapsedMicroseconds;
+      break;
+    }
+    await Future<void>.delayed(poll);
+  }
+
+  generator.stop();
+  simulated?.stop();
+  return (
+    name: 'memory',
+    unit: 'B',
+    target: bytes,
+    reference: reference,
+    measured: measured,
+    detectMicros: detectMicros,
+  );
+}
+
+void _copyTree(Directory from, Directory to) {
+  for (final entity in from.listSync(recursive: true)) {
+    if (entity is! File) continue;
+    final relative = entity.path.substring(from.path.length);
+    File('${to.path}$relative')
+      ..createSync(recursive: true)
+      ..writeAsBytesSync(entity.readAsBytesSync());
+  }
+}
@@ -0,0 +1,54 @@
+import 'dart:async';
+import 'dart:convert';
+
+/// Event-loop lag observed while serving a synthetic request load.
+typedef LagSummary = ({int p50Micros, int p99Micros, int maxMicros});
+
+/// Runs a synthetic request load for [duration] and measures how late a
+/// 1 ms probe timer fires.
+///
+/// Every millisecond [requestsPerTick] requests are queued as separate
+/// events. Each request encodes a small JSON response and calls
+/// [perRequest] (e.g. an admission check reading resource metrics), so
+/// the lag reflects what the metric reads cost a real handler loop.
+Future<LagSummary> measureEventLoopLag(
+  void Function()? perRequest, {
+  Duration duration = const Duration(seconds: 3),
+  int requestsPerTick = 5,
+}) async {
+  const probeInterval = Duration(milliseconds: 1);
+  final lags = <int>[];
+  final clock = Stopwatch()..start();
+  var running = true;
+
+  final load = Timer.periodic(probeInterval, (_) {
+    for (var i = 0; i < requestsPerTick; i++) {
+      Timer.run(() {
+        perRequest?.call();
+        jsonEncode({'status': 'ok', 'id': i, 'at': clock.elapsedMicroseconds});
+      });
+    }
+  });
+
+  void probe() {
+    final scheduled = clock.elapsedMicroseconds;
+    Timer(probeInterval, () {
+      final lag = clock.elapsedMicroseconds - scheduled - 1000;
+      lags.add(lag < 0 ? 0 : lag);
+      if (running) probe();
+    });
+  }
+
+  probe();
+  await Future<void>.delayed(duration);
+  running = false;
+  load.cancel();
+
+  lags.sort();
+  if (lags.isEmpty) return (p50Micros: 0, p99Micros: 0, maxMicros: 0);
+  return (
+    p50Micros: lags[lags.length ~/ 2],
+    p99Micros: lags[((lags.length - 1) * 0.99).floor()],
+    maxMicros: lags.last,
+  );
+}
@@ -0,0 +1,54 @@
+import 'dart:developer';
+import 'dart:isolate';
+
+import 'package:vm_service/vm_service.dart';
+import 'package:vm_service/vm_service_io.dart';
+
+/// Measures bytes allocated per operation from VM service heap stats.
+///
+/// Resets the allocation accumulators, runs the operation, then sums
+/// `accumulatedSize` over every class in the isolate's allocation profile.
+class HeapProfiler {
+  final VmService _service;
+  final String _isolateId;
+
+  HeapProfiler._(this._service, this._isolateId);
+
+  /// Connects to this isolate's VM service, starting it if needed.
+  ///
+  /// Returns `null` when the service is unavailable (e.g. AOT builds).
+  static Future<HeapProfiler?> connect() async {
+    var info = await Service.getInfo();
+    if (info.serverWebSocketUri == null) {
+      info = await Service.controlWebServer(enable: true);
+    }
+    final uri = info.serverWebSocketUri;
+    final isolateId = Service.getIsolateId(Isolate.current);
+    if (uri == null || isolateId == null) return null;
+
+    try {
+      final service = await vmServiceConnectUri(uri.toString());
+      return HeapProfiler._(service, isolateId);
+    } catch (_) {
+      return null;
+    }
+  }
+
+  /// Average bytes allocated by one call of [op] over [iterations] calls.
+  Future<double> bytesPerOp(void Function() op, int iterations) async {
+    await _service.getAllocationProfile(_isolateId, reset: true);
+    for (var i = 0; i < iterations; i++) {
+      op();
+    }
+    final profile = await _service.getAllocationProfile(_isolateId, gc: true);
+
+    var bytes = 0;
+    for (final stats in profile.members ?? const <ClassHeapStats>[]) {
+      bytes += stats.accumulatedSize ?? 0;
+    }
+    return bytes / iterations;
+  }
+
+  /// Closes the VM service connection.
+  Future<void> close() => _service.dispose();
+}
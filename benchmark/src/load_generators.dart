@@ -0,0 +1,120 @@
+import 'dart:async';
+import 'dart:io';
+import 'dart:isolate';
+import 'dart:typed_data';
+
+import 'package:system_resources_2/src/platform_detector.dart';
+
+/// Busy-loops [threads] isolates at [dutyCycle] of each 10 ms period.
+class CpuLoadGenerator {
+  final int threads;
+  final double dutyCycle;
+  final _isolates = <Isolate>[];
+
+  CpuLoadGenerator(this.threads, this.dutyCycle);
+
+  /// CPU the generator is asked to burn, in millicores.
+  int get targetMillicores => (threads * dutyCycle * 1000).round();
+
+  Future<void> start() async {
+    for (var i = 0; i < threads; i++) {
+      _isolates.add(await Isolate.spawn(_spin, dutyCycle));
+    }
+  }
+
+  void stop() {
+    for (final isolate in _isolates) {
+      isolate.kill(priority: Isolate.immediate);
+    }
+    _isolates.clear();
+  }
+
+  static void _spin(double dutyCycle) {
+    const periodMicros = 10000;
+    final busyMicros = (periodMicros * dutyCycle).round();
+    final clock = Stopwatch()..start();
+    while (true) {
+      final start = clock.elapsedMicroseconds;
+      while (clock.elapsedMicroseconds - start < busyMicros) {}
+      final idle = periodMicros - (clock.elapsedMicroseconds - start);
+      if (idle > 0) sleep(Duration(microseconds: idle));
+    }
+  }
+}
+
+/// Allocates a block of [bytes] and writes one byte per page, so every
+/// page is resident rather than just reserved.
+class MemoryLoadGenerator {
+  final int bytes;
+  Uint8List? _block;
+
+  MemoryLoadGenerator(this.bytes);
+
+  void start() {
+    final block = _block = Uint8List(bytes);
+    for (var i = 0; i < bytes; i += 4096) {
+      block[i] = 1;
+    }
+  }
+
+  void stop() => _block = null;
+}
+
+/// CPU time this process has consumed, in microseconds, from the
+/// utime and stime fields of `/proc/self/stat` (USER_HZ ticks).
+///
+/// This is the ground truth the CPU generator is calibrated against: it
+/// counts what the isolates actually burned, independent of the cgroup
+/// files the library reads. Returns -1 if unavailable.
+int processCpuMicros() {
+  try {
+    final stat = File('/proc/self/stat').readAsStringSync();
+    final fields = stat.substring(stat.lastIndexOf(')') + 2).split(' ');
+    final ticks = int.parse(fields[11]) + int.parse(fields[12]);
+    return ticks * 10000;
+  } catch (_) {
+    return -1;
+  }
+}
+
+/// Simulates load by advancing the counters of a cgroup v2 fixture root.
+///
+/// Used where real load cannot be attributed to a cgroup (no cgroup
+/// delegation, macOS, CI sandboxes). `usage_usec` in `cpu.stat` advances
+/// at [millicores] in real time and `memory.current` grows by the bytes
+/// passed to [allocate], so the readers, delta math and detection
+/// latency are exercised against exactly known values.
+class FixtureLoad {
+  final int millicores;
+  Timer? _timer;
+  int _baseUsageMicros = 0;
+  int _baseMemoryBytes = 0;
+
+  FixtureLoad(this.millicores);
+
+  void start() {
+    final cpuStat = File(PlatformDetector.cgroupV2CpuStat);
+    final usage = RegExp(r'^usage_usec (\d+)$', multiLine: true);
+    final content = cpuStat.readAsStringSync();
+    _baseUsageMicros = int.parse(usage.firstMatch(content)!.group(1)!);
+    _baseMemoryBytes = int.parse(
+        File(PlatformDetector.cgroupV2MemoryCurrent)
+            .readAsStringSync()
+            .trim());
+
+    if (millicores <= 0) return;
+    final clock = Stopwatch()..start();
+    _timer = Timer.periodic(const Duration(milliseconds: 10), (_) {
+      final burned = clock.elapsedMicroseconds * millicores ~/ 1000;
+      cpuStat.writeAsStringSync(content.replaceFirst(
+          usage, 'usage_usec ${_baseUsageMicros + burned}'));
+    });
+  }
+
+  void allocate(int bytes) {
+    File(PlatformDetector.cgroupV2MemoryCurrent)
+        .writeAsStringSync('${_baseMemoryBytes + bytes}\n');
+  }
+
+  void stop() => _timer?.cancel();
+}
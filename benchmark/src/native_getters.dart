@@ -0,0 +1,66 @@
+import 'dart:ffi';
+import 'dart:io';
+
+import 'package:system_resources_2/src/macos_native.dart';
+
+typedef IsContainerEnvNative = Int32 Function();
+typedef IsContainerEnv = int Function();
+
+/// Leaf FFI bindings to a locally built libsysres, used as the native
+/// baseline for the pure Dart readers.
+///
+/// The library is looked up at `SYSRES_LIB`, or at the `make` output in
+/// `lib/build/` for the current ABI. Leaf calls skip the safepoint
+/// transition, so they measure the cheapest possible native call.
+class NativeGetters {
+  final GetCpuLoad cpuLoad;
+  final GetCpuLimitCores cpuLimitCores;
+  final GetMemoryUsage memoryUsage;
+  final GetMemoryLimitBytes memoryLimitBytes;
+  final GetMemoryUsedBytes memoryUsedBytes;
+  final IsContainerEnv isContainerEnv;
+
+  /// Path of the loaded library.
+  final String path;
+
+  NativeGetters._(DynamicLibrary lib, this.path)
+      : cpuLoad = lib.lookupFunction<GetCpuLoadNative, GetCpuLoad>(
+            'get_cpu_load',
+            isLeaf: true),
+        cpuLimitCores =
+            lib.lookupFunction<GetCpuLimitCoresNative, GetCpuLimitCores>(
+                'get_cpu_limit_cores',
+                isLeaf: true),
+        memoryUsage = lib.lookupFunction<GetMemoryUsageNative, GetMemoryUsage>(
+            'get_memory_usage',
+            isLeaf: true),
+        memoryLimitBytes =
+            lib.lookupFunction<GetMemoryLimitBytesNative, GetMemoryLimitBytes>(
+                'get_memory_limit_bytes',
+                isLeaf: true),
+        memoryUsedBytes =
+            lib.lookupFunction<GetMemoryUsedBytesNative, GetMemoryUsedBytes>(
+                'get_memory_used_bytes',
+                isLeaf: true),
+        isContainerEnv =
+            lib.lookupFunction<IsContainerEnvNative, IsContainerEnv>(
+                'is_container_env',
+                isLeaf: true);
+
+  /// Loads the library, or returns `null` if it has not been built.
+  static NativeGetters? load() {
+    final path = Platform.environment['SYSRES_LIB'] ?? _defaultPath();
+    if (path == null || !File(path).existsSync()) return null;
+    return NativeGetters._(DynamicLibrary.open(path), path);
+  }
+
+  static String? _defaultPath() => switch (Abi.current()) {
+        Abi.linuxX64 => 'lib/build/libsysres-linux-x86_64.so',
+        Abi.linuxArm64 => 'lib/build/libsysres-linux-aarch64.so',
+        Abi.linuxArm => 'lib/build/libsysres-linux-armv7l.so',
+        Abi.linuxIA32 => 'lib/build/libsysres-linux-i686.so',
+        Abi.macosArm64 => 'lib/build/libsysres-darwin-arm64.dylib',
+        Abi.macosX64 => 'lib/build/libsysres-darwin-x86_64.dylib',
+        _ => null,
+      };
+}
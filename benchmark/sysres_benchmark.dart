@@ -0,0 +1,276 @@
+/// Cost of every public getter in each read mode.
+///
+/// Usage: `dart run benchmark/sysres_benchmark.dart [filter]`
+///
+/// Modes:
+/// - `dart`: the default read (pure Dart on Linux, FFI on macOS)
+/// - `ttl`: coalesced read with a 1 s freshness window (cache hit path)
+/// - `ffi`: leaf FFI call into a libsysres built with `make`
+/// - `sampler`: field read from the latest sampler snapshot
+///
+/// For each getter and mode it prints ns/op and bytes allocated/op (from
+/// VM service heap stats), then the event-loop lag of a synthetic request
+/// load that reads `cpuLoadAvg` and `memUsage` on every request. On Linux
+/// it then times each backend's `readAll()` (one sampler tick) under the
+/// fixture roots in `test/fixtures`, with the source reads and system
+/// calls it costs. Only benchmarks whose name contains `filter` are run.
+library;
+
+import 'dart:io';
+
+import 'package:benchmark_harness/benchmark_harness.dart';
+import 'package:system_resources_2/src/platform_detector.dart';
+import 'package:system_resources_2/src/resource_backend.dart';
+import 'package:system_resources_2/src/resource_sampler.dart';
+import 'package:system_resources_2/system_resources_2.dart';
+
+import 'src/event_loop_load.dart';
+import 'src/heap_profiler.dart';
+import 'src/native_getters.dart';
+
+const _ttl = 1000000;
+const _allocationIterations = 10000;
+const _ioIterations = 1000;
+
+/// Fixture roots the backend rows run under, from `test/fixtures`.
+const _fixtureRoots = ['gvisor', 'cgroup-v2', 'cgroup-v1', 'host-256cpu'];
+
+/// Keeps results observable so reads are not optimized away.
+num _sink = 0;
+
+class _GetterBenchmark extends BenchmarkBase {
+  final num Function() _read;
+
+  _GetterBenchmark(super.name, this._read);
+
+  @override
+  void run() => _sink += _read();
+
+  /// One read per measured call, so `measure()` is microseconds per op.
+  @override
+  void exercise() => run();
+}
+
+/// One public getter and how to read it in each mode (`null` if the mode
+/// does not provide it).
+class _Getter {
+  final String name;
+  final num Function() dart;
+  final num Function() ttl;
+  final num Function()? ffi;
+  final num Function()? sampler;
+
+  const _Getter(this.name, this.dart, this.ttl, {this.ffi, this.sampler});
+
+  Iterable<(String, num Function())> get modes => [
+        ('dart', dart),
+        ('ttl', ttl),
+        if (ffi case final ffi?) ('ffi', ffi),
+        if (sampler case final sampler?) ('sampler', sampler),
+      ];
+}
+
+num _bool(bool value) => value ? 1 : 0;
+
+/// Backends compared under a root detected as [platform]: the gVisor and
+/// `/proc` backends everywhere, and the cgroup backend with and without
+/// PSI (as selected inside gVisor) where the root has cgroupfs. Built
+/// after the root is set, since the gVisor backend reads its limits once.
+Map<String, ResourceBackend> _backends(DetectedPlatform platform) => {
+      'gvisor': GVisorBackend(),
+      'proc': const ProcBackend(),
+      if (platform == DetectedPlatform.linuxCgroupV2) ...{
+        'cgroup': const CgroupBackend.v2(),
+        'cgroup-no-psi': const CgroupBackend.v2(pressure: false),
+      },
+      if (platform == DetectedPlatform.linuxCgroupV1) ...{
+        'cgroup': const CgroupBackend.v1(),
+        'cgroup-no-psi': const CgroupBackend.v1(pressure: false),
+      },
+    };
+
+/// Source reads and system calls counted so far, over all sources.
+({int reads, int syscalls}) _ioTotals() {
+  var reads = 0;
+  var syscalls = 0;
+  final overhead = SystemResources.monitoringOverhead();
+  for (final stats in overhead.sources.values) {
+    reads += stats.reads;
+    syscalls += stats.syscalls;
+  }
+  return (reads: reads, syscalls: syscalls);
+}
+
+List<_Getter> _getters(NativeGetters? native) {
+  ResourceSnapshot latest() => SystemResources.snapshot();
+
+  return [
+    _Getter(
+      'cpuLoadAvg',
+      SystemResources.cpuLoadAvg,
+      () => SystemResources.cpuLoadAvg(maxStalenessMicros: _ttl),
+      ffi: native?.cpuLoad,
+    ),
+    _Getter(
+      'cpuLoad',
+      SystemResources.cpuLoad,
+      () => SystemResources.cpuLoad(maxStalenessMicros: _ttl),
+      sampler: () => latest().cpuUtilization,
+    ),
+    _Getter(
+      'cpuUsageMillicores',
+      SystemResources.cpuUsageMillicores,
+      () => SystemResources.cpuUsageMillicores(maxStalenessMicros: _ttl),
+      sampler: () => latest().cpuUsageMillicores,
+    ),
+    _Getter(
+      'cpuUsageMicros',
+      SystemResources.cpuUsageMicros,
+      () => SystemResources.cpuUsageMicros(maxStalenessMicros: _ttl),
+    ),
+    _Getter(
+      'cpuLimitCores',
+      SystemResources.cpuLimitCores,
+      () => SystemResources.cpuLimitCores(maxStalenessMicros: _ttl),
+      ffi: native?.cpuLimitCores,
+      sampler: () => latest().cpuLimitCores,
+    ),
+    _Getter(
+      'cpuLimitMillicores',
+      SystemResources.cpuLimitMillicores,
+      () => SystemResources.cpuLimitMillicores(maxStalenessMicros: _ttl),
+    ),
+    _Getter(
+      'memUsage',
+      SystemResources.memUsage,
+      () => SystemResources.memUsage(maxStalenessMicros: _ttl),
+      ffi: native?.memoryUsage,
+      sampler: () {
+        final snapshot = latest();
+        return snapshot.memoryUsedBytes / snapshot.memoryLimitBytes;
+      },
+    ),
+    _Getter(
+      'memoryLimitBytes',
+      SystemResources.memoryLimitBytes,
+      () => SystemResources.memoryLimitBytes(maxStalenessMicros: _ttl),
+      ffi: native?.memoryLimitBytes,
+      sampler: () => latest().memoryLimitBytes,
+    ),
+    _Getter(
+      'memoryUsedBytes',
+      SystemResources.memoryUsedBytes,
+      () => SystemResources.memoryUsedBytes(maxStalenessMicros: _ttl),
+      ffi: native?.memoryUsedBytes,
+      sampler: () => latest().memoryUsedBytes,
+    ),
+    _Getter(
+      'isContainerEnv',
+      () => _bool(SystemResources.isContainerEnv()),
+      () => _bool(SystemResources.isContainerEnv()),
+      ffi: native?.isContainerEnv,
+    ),
+  ];
+}
+
+Future<void> main(List<String> args) async {
+  final filter = args.isEmpty ? '' : args.first;
+  await SystemResources.init();
+
+  final native = NativeGetters.load();
+  final profiler = await HeapProfiler.connect();
+  print('ffi: ${native?.path ?? 'not built (run make)'}');
+  if (profiler == null) print('bytes/op: VM service unavailable');
+
+  // The sampler mode reads the snapshot this keeps fresh.
+  SystemResources.startSampler(interval: const Duration(milliseconds: 100));
+
+  print('${'benchmark'.padRight(32)}${'ns/op'.padLeft(12)}'
+      '${'bytes/op'.padLeft(12)}');
+  final benchmarks = [
+    for (final getter in _getters(native))
+      for (final (mode, read) in getter.modes)
+        _GetterBenchmark('${getter.name}/$mode', read),
+    _GetterBenchmark('sampler/tick', () {
+      ResourceSampler.sample();
+      return 0;
+    }),
+  ];
+  for (final benchmark in benchmarks) {
+    if (!benchmark.name.contains(filter)) continue;
+
+    final nanos = benchmark.measure() * 1000;
+    final bytes =
+        await profiler?.bytesPerOp(benchmark.run, _allocationIterations);
+    print('${benchmark.name.padRight(32)}'
+        '${nanos.toStringAsFixed(0).padLeft(12)}'
+        '${(bytes?.toStringAsFixed(1) ?? '-').padLeft(12)}');
+  }
+
+  print('\nevent-loop lag under load (cpuLoadAvg + memUsage per request)');
+  print('${'mode'.padRight(32)}${'p50 us'.padLeft(12)}'
+      '${'p99 us'.padLeft(12)}${'max us'.padLeft(12)}');
+  final loads = <String, void Function()?>{
+    'baseline': null,
+    'dart': () =>
+        _sink += SystemResources.cpuLoadAvg() + SystemResources.memUsage(),
+    'ttl': () => _sink +=
+        SystemResources.cpuLoadAvg(maxStalenessMicros: _ttl) +
+            SystemResources.memUsage(maxStalenessMicros: _ttl),
+    if (native != null)
+      'ffi': () => _sink += native.cpuLoad() + native.memoryUsage(),
+    'sampler': () {
+      final snapshot = SystemResources.snapshot();
+      _sink += snapshot.cpuUtilization +
+          snapshot.memoryUsedBytes / snapshot.memoryLimitBytes;
+    },
+  };
+  for (final MapEntry(key: mode, value: perRequest) in loads.entries) {
+    if (!'load/$mode'.contains(filter)) continue;
+
+    final lag = await measureEventLoopLag(perRequest);
+    print('${'load/$mode'.padRight(32)}${'${lag.p50Micros}'.padLeft(12)}'
+        '${'${lag.p99Micros}'.padLeft(12)}${'${lag.maxMicros}'.padLeft(12)}');
+  }
+
+  SystemResources.stopSampler();
+  await profiler?.close();
+  if (Platform.isLinux) _benchmarkBackends(filter);
+}
+
+/// Times `readAll()` of each backend under each fixture root and counts
+/// the source reads and system calls of one call.
+void _benchmarkBackends(String filter) {
+  print('\nbackend readAll() per tick under fixture roots');
+  print('${'benchmark'.padRight(32)}${'ns/op'.padLeft(12)}'
+      '${'reads/op'.padLeft(12)}${'syscalls/op'.padLeft(12)}');
+  for (final name in _fixtureRoots) {
+    PlatformDetector.setRoot(Directory('test/fixtures/$name').absolute.path);
+    SystemResources.clearState();
+    final backends = _backends(PlatformDetector.detectPlatform());
+    for (final MapEntry(key: backendName, value: backend)
+        in backends.entries) {
+      final benchmark = _GetterBenchmark('backend/$name/$backendName', () {
+        backend.readAll();
+        return 0;
+      });
+      if (!benchmark.name.contains(filter)) continue;
+
+      final nanos = benchmark.measure() * 1000;
+      final before = _ioTotals();
+      for (var i = 0; i < _ioIterations; i++) {
+        benchmark.run();
+      }
+      final after = _ioTotals();
+      final reads = (after.reads - before.reads) / _ioIterations;
+      final syscalls =
+          (after.syscalls - before.syscalls) / _ioIterations;
+      print('${benchmark.name.padRight(32)}'
+          '${nanos.toStringAsFixed(0).padLeft(12)}'
+          '${reads.toStringAsFixed(1).padLeft(12)}'
+          '${syscalls.toStringAsFixed(1).padLeft(12)}');
+    }
+  }
+  PlatformDetector.setRoot(null);
+  SystemResources.clearState();
+}
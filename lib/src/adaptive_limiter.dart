@@ -0,0 +1,116 @@
+import 'dart:async';
+
+import 'resource_sampler.dart';
+
+/// Adaptive concurrency limiter driven by resource signals (AIMD).
+///
+/// On every sampler tick the limit is:
+/// - **decreased multiplicatively** (by [backoffRatio]) when the process is
+///   overloaded: CFS throttled ratio above [maxThrottledRatio], PSI CPU
+///   `some avg10` above [maxCpuPressure], or working-set headroom below
+///   [minMemoryHeadroom];
+/// - **increased additively** by one otherwise, but only while the limit is
+///   actually being used (in-flight requests at least half the limit), so
+///   an idle server does not drift to [maxLimit].
+///
+/// [tryAcquire] and [release] are plain counter updates. A Dart isolate is
+/// single-threaded, so no atomics or locks are needed; use one limiter per
+/// isolate.
+///
+/// ```dart
+/// final limiter = SystemResources.adaptiveLimiter();
+///
+/// if (!limiter.tryAcquire()) return reject(503);
+/// try {
+///   await handle(request);
+/// } finally {
+///   limiter.release();
+/// }
+/// ```
+class AdaptiveLimiter {
+  final int minLimit;
+  final int maxLimit;
+  final double backoffRatio;
+  final double maxThrottledRatio;
+  final double maxCpuPressure;
+  final double minMemoryHeadroom;
+
+  int _limit;
+  int _inFlight = 0;
+  int _rejected = 0;
+  StreamSubscription<ResourceSnapshot>? _subscription;
+
+  AdaptiveLimiter({
+    int initialLimit = 20,
+    this.minLimit = 1,
+    this.maxLimit = 1000,
+    this.backoffRatio = 0.9,
+    this.maxThrottledRatio = 0.1,
+    this.maxCpuPressure = 0.1,
+    this.minMemoryHeadroom = 0.1,
+  }) : _limit = initialLimit.clamp(minLimit, maxLimit) {
+    if (minLimit < 1 || maxLimit < minLimit) {
+      throw ArgumentError('Requires 1 <= minLimit <= maxLimit');
+    }
+    if (backoffRatio <= 0 || backoffRatio >= 1) {
+      throw ArgumentError.value(
+          backoffRatio, 'backoffRatio', 'Must be in (0, 1)');
+    }
+  }
+
+  /// Current concurrency limit.
+  int get limit => _limit;
+
+  /// Number of acquired, not yet released permits.
+  int get inFlight => _inFlight;
+
+  /// Number of [tryAcquire] calls rejected since creation.
+  int get rejected => _rejected;
+
+  /// Takes a permit if the limit allows it. Returns `false` otherwise.
+  bool tryAcquire() {
+    if (_inFlight >= _limit) {
+      _rejected++;
+      return false;
+    }
+    _inFlight++;
+    return true;
+  }
+
+  /// Returns a permit taken with [tryAcquire].
+  void release() {
+    if (_inFlight > 0) _inFlight--;
+  }
+
+  /// Returns `true` if [snapshot] indicates overload.
+  bool isOverloaded(ResourceSnapshot snapshot) {
+    final limit = snapshot.memoryLimitBytes;
+    final headroom = limit > 0 ? 1.0 - snapshot.workingSetBytes / limit : 1.0;
+    return snapshot.throttledRatio > maxThrottledRatio ||
+        snapshot.cpuPressure > maxCpuPressure ||
+        headroom < minMemoryHeadroom;
+  }
+
+  /// Adjusts the limit from [snapshot]. Called on every sampler tick when
+  /// attached.
+  void update(ResourceSnapshot snapshot) {
+    if (isOverloaded(snapshot)) {
+      final reduced = (_limit * backoffRatio).floor();
+      _limit = reduced < minLimit ? minLimit : reduced;
+    } else if (_inFlight * 2 >= _limit && _limit < maxLimit) {
+      _limit++;
+    }
+  }
+
+  /// Updates the limit on every snapshot of [snapshots] until [close].
+  void attach(Stream<ResourceSnapshot> snapshots) {
+    _subscription?.cancel();
+    _subscription = snapshots.listen(update);
+  }
+
+  /// Stops following sampler snapshots.
+  Future<void> close() async {
+    await _subscription?.cancel();
+    _subscription = null;
+  }
+}
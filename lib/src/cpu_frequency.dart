@@ -0,0 +1,158 @@
+import 'cpu_topology.dart';
+import 'platform_detector.dart';
+import 'self_stats.dart';
+
+/// Clock speed and thermal throttling of the CPUs this process may run on.
+class CpuFrequency {
+  /// Whether cpufreq is exposed. When `false`, [capacityFactor] is 1.0 and
+  /// the frequencies are 0.
+  final bool available;
+
+  /// Mean current and maximum frequency of the sampled CPUs, in kHz.
+  final int currentKhz;
+  final int maxKhz;
+
+  /// Mean of current / maximum frequency: the share of peak throughput a
+  /// busy CPU delivers right now. Multiply millicores by it to compare
+  /// work done across clock changes. 1.0 when unknown.
+  final double capacityFactor;
+
+  /// Cumulative thermal throttle events (`core_throttle_count` per core
+  /// plus `package_throttle_count` per package), 0 where the kernel does
+  /// not expose `thermal_throttle` (non-Intel, VMs).
+  final int thermalThrottleCount;
+
+  const CpuFrequency({
+    this.available = false,
+    this.currentKhz = 0,
+    this.maxKhz = 0,
+    this.capacityFactor = 1.0,
+    this.thermalThrottleCount = 0,
+  });
+
+  static const unavailable = CpuFrequency();
+}
+
+/// Reads cpufreq and thermal throttle counters from sysfs.
+///
+/// Per call it reads `cpufreq/scaling_cur_freq` for the allowed CPUs (see
+/// [TopologyReader]) and `thermal_throttle/*_throttle_count` for one CPU
+/// per core and per package. At most [maxCpus] CPUs and cores are read,
+/// evenly spread, so large hosts cost a bounded number of reads per tick.
+/// `cpuinfo_max_freq` and the set of files that exist are resolved once;
+/// if cpufreq is missing nothing is read again until [clearState].
+class CpuFrequencyMonitor {
+  static const maxCpus = 32;
+
+  static _Plan? _plan;
+  static bool _resolved = false;
+
+  static CpuFrequency read() {
+    if (!_resolved) {
+      _plan = _resolve();
+      _resolved = true;
+    }
+    final plan = _plan;
+    if (plan == null) return CpuFrequency.unavailable;
+
+    var currentSum = 0;
+    var maxSum = 0;
+    var ratioSum = 0.0;
+    var count = 0;
+    for (final (index, cpu) in plan.cpus.indexed) {
+      final current = _readInt('${_cpuDir(cpu)}/cpufreq/scaling_cur_freq');
+      final max = plan.maxKhz[index];
+      if (current == null || max <= 0) continue;
+      currentSum += current;
+      maxSum += max;
+      ratioSum += current / max;
+      count++;
+    }
+    if (count == 0) return CpuFrequency.unavailable;
+
+    var throttles = 0;
+    for (final path in plan.throttleFiles) {
+      throttles += _readInt(path) ?? 0;
+    }
+    return CpuFrequency(
+      available: true,
+      currentKhz: currentSum ~/ count,
+      maxKhz: maxSum ~/ count,
+      capacityFactor: ratioSum / count,
+      thermalThrottleCount: throttles,
+    );
+  }
+
+  /// Works out which CPUs and files to read. `null` if cpufreq is absent.
+  static _Plan? _resolve() {
+    final platform = PlatformDetector.detectPlatform();
+    if (platform == DetectedPlatform.macOS ||
+        platform == DetectedPlatform.unsupported) {
+      return null;
+    }
+
+    final topology = TopologyReader.read();
+    final cpus = <int>[];
+    final maxKhz = <int>[];
+    for (final cpu in _spread(topology.cpus)) {
+      final max = _readInt('${_cpuDir(cpu)}/cpufreq/cpuinfo_max_freq');
+      if (max == null) continue;
+      cpus.add(cpu);
+      maxKhz.add(max);
+    }
+    if (cpus.isEmpty) return null;
+
+    final throttleFiles = <String>[];
+    final packages = <String>{};
+    for (final core in _spread(topology.cores)) {
+      final dir = '${_cpuDir(core.first)}/thermal_throttle';
+      if (_readInt('$dir/core_throttle_count') == null) continue;
+      throttleFiles.add('$dir/core_throttle_count');
+
+      final package = _readTrimmed(
+              '${_cpuDir(core.first)}/topology/physical_package_id') ??
+          '0';
+      if (packages.add(package) &&
+          _readInt('$dir/package_throttle_count') != null) {
+        throttleFiles.add('$dir/package_throttle_count');
+      }
+    }
+    return _Plan(cpus, maxKhz, throttleFiles);
+  }
+
+  /// At most [maxCpus] entries of [items], evenly spaced.
+  static List<T> _spread<T>(List<T> items) {
+    if (items.length <= maxCpus) return items;
+    return [
+      for (var i = 0; i < maxCpus; i++) items[i * items.length ~/ maxCpus]
+    ];
+  }
+
+  static String _cpuDir(int cpu) => '${PlatformDetector.sysCpuDir}/cpu$cpu';
+
+  static int? _readInt(String path) {
+    final text = _readTrimmed(path);
+    return text == null ? null : SelfStats.parseInt(text, path);
+  }
+
+  static String? _readTrimmed(String path) {
+    try {
+      return SelfStats.readFile(path).trim();
+    } catch (_) {}
+    return null;
+  }
+
+  /// Drops the resolved CPUs and files. Useful for testing.
+  static void clearState() {
+    _plan = null;
+    _resolved = false;
+  }
+}
+
+class _Plan {
+  final List<int> cpus;
+  final List<int> maxKhz;
+  final List<String> throttleFiles;
+
+  const _Plan(this.cpus, this.maxKhz, this.throttleFiles);
+}
@@ -1,6 +1,7 @@
 import 'dart:io';
 
 import 'platform_detector.dart';
+import 'self_stats.dart';
 
 /// CPU monitoring using cgroup metrics and /proc/loadavg fallback.
 ///
@@ -22,13 +23,14 @@ class CpuMonitor {
   /// Parses `usage_usec` from `/sys/fs/cgroup/cpu.stat`.
   /// Returns 0 if unable to read.
   static int readV2UsageMicros() {
+    final path = PlatformDetector.cgroupV2CpuStat;
     try {
-      final content = File(PlatformDetector.cgroupV2CpuStat).readAsStringSync();
+      final content = SelfStats.readFile(path);
       for (final line in content.split('\n')) {
         if (line.startsWith('usage_usec')) {
           final parts = line.split(' ');
           if (parts.length >= 2) {
-            return int.tryParse(parts[1]) ?? 0;
+            return SelfStats.parseInt(parts[1], path) ?? 0;
           }
         }
       }
@@ -42,23 +44,91 @@ class CpuMonitor {
   /// `cpu,cpuacct` alternative mount.
   /// Returns 0 if unable to read.
   static int readV1UsageMicros() {
-    for (final path in [
+    final paths = [
       PlatformDetector.cgroupV1CpuAcctUsage,
       PlatformDetector.cgroupV1CpuAcctUsageAlt,
-    ]) {
+    ];
+    for (var i = 0; i < paths.length; i++) {
       try {
-        final file = File(path);
-        if (file.existsSync()) {
-          final nanos = int.tryParse(file.readAsStringSync().trim());
-          if (nanos != null) {
-            return nanos ~/ 1000; // Convert to microseconds
-          }
+        if (i > 0) SelfStats.fallback(paths[i]);
+        final nanos =
+            SelfStats.parseInt(SelfStats.readFile(paths[i]).trim(), paths[i]);
+        if (nanos != null) {
+          return nanos ~/ 1000; // Convert to microseconds
         }
       } catch (_) {}
     }
     return 0;
   }
 
+  /// Reads host-wide busy CPU time from `/proc/stat` in microseconds.
+  ///
+  /// Sums the non-idle fields of the aggregate `cpu` line (user, nice,
+  /// system, irq, softirq, steal), which are in USER_HZ (100/s on Linux).
+  /// Returns 0 if unable to read.
+  static int readProcStatUsageMicros() {
+    final path = PlatformDetector.procStat;
+    try {
+      final content = SelfStats.readFile(path);
+      final newline = content.indexOf('\n');
+      final line = newline < 0 ? content : content.substring(0, newline);
+      if (!line.startsWith('cpu ')) return 0;
+
+      final fields = line.trim().split(RegExp(r'\s+'));
+      if (fields.length < 9) return 0;
+
+      var busyTicks = 0;
+      for (final index in const [1, 2, 3, 6, 7, 8]) {
+        busyTicks += SelfStats.parseInt(fields[index], path) ?? 0;
+      }
+      return busyTicks * 10000; // USER_HZ ticks to microseconds
+    } catch (_) {}
+    return 0;
+  }
+
+  // ---------------------------------------------------------------------------
+  // CFS throttling readers
+  // ---------------------------------------------------------------------------
+
+  /// Reads CFS bandwidth counters from cgroup v2 `cpu.stat`.
+  ///
+  /// Returns zero counters if unable to read or if no CPU limit is set.
+  static ({int periods, int throttled}) readV2ThrottleStats() =>
+      _readThrottleStats(PlatformDetector.cgroupV2CpuStat) ??
+      (periods: 0, throttled: 0);
+
+  /// Reads CFS bandwidth counters from cgroup v1 `cpu.stat`.
+  ///
+  /// Tries both the `cpu` and `cpu,cpuacct` mounts.
+  static ({int periods, int throttled}) readV1ThrottleStats() {
+    final stats = _readThrottleStats(PlatformDetector.cgroupV1CpuStat);
+    if (stats != null) return stats;
+
+    SelfStats.fallback(PlatformDetector.cgroupV1CpuStatAlt);
+    return _readThrottleStats(PlatformDetector.cgroupV1CpuStatAlt) ??
+        (periods: 0, throttled: 0);
+  }
+
+  /// Parses `nr_periods` and `nr_throttled` (same keys on v1 and v2).
+  static ({int periods, int throttled})? _readThrottleStats(String path) {
+    try {
+      final content = SelfStats.readFile(path);
+      int? periods;
+      int? throttled;
+      for (final line in content.split('\n')) {
+        if (line.startsWith('nr_periods ')) {
+          periods = SelfStats.parseInt(line.substring(11).trim(), path);
+        } else if (line.startsWith('nr_throttled ')) {
+          throttled = SelfStats.parseInt(line.substring(13).trim(), path);
+        }
+      }
+      if (periods != null && throttled != null) {
+        return (periods: periods, throttled: throttled);
+      }
+    } catch (_) {}
+    return null;
+  }
+
   // ---------------------------------------------------------------------------
   // CPU limit readers (millicores)
   // ---------------------------------------------------------------------------
@@ -68,15 +138,15 @@ class CpuMonitor {
   /// Parses `/sys/fs/cgroup/cpu.max` (format: `"quota period"`).
   /// Returns -1 if unlimited or unable to determine.
   static int readV2LimitMillicores() {
+    final path = PlatformDetector.cgroupV2CpuMax;
     try {
-      final content =
-          File(PlatformDetector.cgroupV2CpuMax).readAsStringSync().trim();
+      final content = SelfStats.readFile(path).trim();
       final parts = content.split(' ');
       if (parts.length >= 2) {
         if (parts[0] == 'max') return -1; // Unlimited
 
-        final quota = int.tryParse(parts[0]);
-        final period = int.tryParse(parts[1]);
+        final quota = SelfStats.parseInt(parts[0], path);
+        final period = SelfStats.parseInt(parts[1], path);
         if (quota != null && period != null && period > 0) {
           return (quota * 1000) ~/ period;
         }
@@ -102,18 +172,16 @@ class CpuMonitor {
 
     for (var i = 0; i < quotaPaths.length; i++) {
       try {
-        final quotaFile = File(quotaPaths[i]);
-        final periodFile = File(periodPaths[i]);
-
-        if (quotaFile.existsSync() && periodFile.existsSync()) {
-          final quota = int.tryParse(quotaFile.readAsStringSync().trim());
-          final period = int.tryParse(periodFile.readAsStringSync().trim());
-
-          if (quota != null && period != null) {
-            if (quota == -1) return -1; // Unlimited
-            if (period > 0) {
-              return (quota * 1000) ~/ period;
-            }
+        if (i > 0) SelfStats.fallback(quotaPaths[i]);
+        final quota = SelfStats.parseInt(
+            SelfStats.readFile(quotaPaths[i]).trim(), quotaPaths[i]);
+        final period = SelfStats.parseInt(
+            SelfStats.readFile(periodPaths[i]).trim(), periodPaths[i]);
+
+        if (quota != null && period != null) {
+          if (quota == -1) return -1; // Unlimited
+          if (period > 0) {
+            return (quota * 1000) ~/ period;
           }
         }
       } catch (_) {}
@@ -121,6 +189,19 @@ class CpuMonitor {
     return -1;
   }
 
+  /// Reads the CPU limit from the downward API `cpu_limit` file (written
+  /// with `divisor: 1m`, so the value is already in millicores).
+  /// Returns -1 if the file is missing or not a positive number.
+  static int readDownwardLimitMillicores() {
+    final path = '${PlatformDetector.downwardApiDir}/cpu_limit';
+    try {
+      final millicores =
+          SelfStats.parseInt(SelfStats.readFile(path).trim(), path);
+      if (millicores != null && millicores > 0) return millicores;
+    } catch (_) {}
+    return -1;
+  }
+
   // ---------------------------------------------------------------------------
   // /proc fallback
   // ---------------------------------------------------------------------------
@@ -130,15 +211,17 @@ class CpuMonitor {
   /// `/proc/loadavg` format: `"0.00 0.01 0.05 1/234 12345"`
   /// First value is 1-minute load average.
   static double readProcLoadAvg() {
+    final path = PlatformDetector.procLoadAvg;
     try {
-      final content = File(PlatformDetector.procLoadAvg).readAsStringSync();
+      final content = SelfStats.readFile(path);
       final parts = content.split(' ');
       if (parts.isNotEmpty) {
         final loadAvg = double.tryParse(parts[0]);
         if (loadAvg != null) {
-          final cpuCount = Platform.numberOfProcessors;
+          final cpuCount = PlatformDetector.cpuCount();
           return loadAvg / cpuCount;
         }
+        SelfStats.parseFailed(path);
       }
     } catch (_) {}
     return 0.0;
@@ -209,16 +292,22 @@ class CpuMonitor {
     }
 
     // Fallback: check environment variable (for gVisor)
-    final envLimit = Platform.environment['SYSRES_CPU_CORES'];
-    if (envLimit != null) {
-      final cores = double.tryParse(envLimit);
-      if (cores != null && cores > 0) {
-        return cores;
-      }
-    }
+    final envCores = _envLimitCores;
+    if (envCores != null) return envCores;
 
     // Fallback: host CPU count
-    return Platform.numberOfProcessors.toDouble();
+    return PlatformDetector.cpuCount().toDouble();
+  }
+
+  /// `SYSRES_CPU_CORES` parsed once. The process environment cannot change
+  /// after start, so there is no need to re-parse it on every sample.
+  static final double? _envLimitCores = _parseEnvLimitCores();
+
+  static double? _parseEnvLimitCores() {
+    final envLimit = Platform.environment['SYSRES_CPU_CORES'];
+    if (envLimit == null) return null;
+    final cores = double.tryParse(envLimit);
+    return cores != null && cores > 0 ? cores : null;
   }
 
   /// Clears the cached previous reading. Useful for testing.
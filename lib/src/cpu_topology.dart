@@ -0,0 +1,331 @@
+import 'dart:io';
+
+import 'platform_detector.dart';
+import 'self_stats.dart';
+
+/// One CPU cache level as seen from the CPUs this process may run on.
+class CacheLevel {
+  /// 1, 2, 3, ...
+  final int level;
+
+  /// `Data`, `Instruction` or `Unified`.
+  final String type;
+
+  /// Size of one instance of the cache in bytes.
+  final int sizeBytes;
+
+  /// Coherency line size in bytes (0 if unknown).
+  final int lineBytes;
+
+  /// Logical CPUs sharing one instance, counting CPUs outside the cpuset
+  /// (e.g. 2 for a per-core L2 with SMT, 16 for an L3 shared by a CCX).
+  final int sharedByCpus;
+
+  /// Distinct instances the allowed CPUs use. Sizing a structure per
+  /// instance (e.g. one shard per L3) uses this.
+  final int instances;
+
+  const CacheLevel({
+    required this.level,
+    required this.type,
+    required this.sizeBytes,
+    this.lineBytes = 0,
+    this.sharedByCpus = 1,
+    this.instances = 1,
+  });
+
+  /// Total bytes of this level reachable from the allowed CPUs.
+  int get totalBytes => sizeBytes * instances;
+}
+
+/// Hardware topology restricted to the CPUs this process may run on (the
+/// online CPUs intersected with the cgroup cpuset and scheduler affinity).
+class CpuTopology {
+  /// Logical CPU ids the process may run on, ascending.
+  final List<int> cpus;
+
+  /// Allowed logical CPUs grouped by physical core: each inner list holds
+  /// SMT siblings.
+  final List<List<int>> cores;
+
+  /// Physical packages (sockets) the allowed CPUs belong to.
+  final int packages;
+
+  /// Cache levels reachable from the allowed CPUs, L1 first. Empty when
+  /// the platform does not expose them.
+  final List<CacheLevel> caches;
+
+  /// Allowed logical CPUs per NUMA node. A single node 0 holding every
+  /// allowed CPU when the platform has no NUMA information.
+  final Map<int, List<int>> numaNodes;
+
+  const CpuTopology({
+    required this.cpus,
+    required this.cores,
+    this.packages = 1,
+    this.caches = const [],
+    this.numaNodes = const {},
+  });
+
+  /// Topology of [count] CPUs with no SMT, cache or NUMA information, used
+  /// where sysfs is unavailable.
+  factory CpuTopology.flat(int count) {
+    final cpus = [for (var i = 0; i < count; i++) i];
+    return CpuTopology(
+      cpus: cpus,
+      cores: [
+        for (final cpu in cpus) [cpu]
+      ],
+      numaNodes: {0: cpus},
+    );
+  }
+
+  int get logicalCpus => cpus.length;
+  int get physicalCores => cores.length;
+
+  /// Most SMT siblings allowed on one core (1 without SMT).
+  int get threadsPerCore => cores.fold(
+      1, (threads, core) => core.length > threads ? core.length : threads);
+
+  CacheLevel? get l1d => cache(1, 'Data');
+  CacheLevel? get l2 => cache(2);
+  CacheLevel? get l3 => cache(3);
+
+  /// The cache at [level] of [type], or the unified one when [type] is
+  /// omitted. `null` if not present.
+  CacheLevel? cache(int level, [String type = 'Unified']) {
+    for (final cache in caches) {
+      if (cache.level == level && cache.type == type) return cache;
+    }
+    return null;
+  }
+}
+
+/// Reads [CpuTopology] from sysfs once.
+///
+/// Sources (Linux, all under [PlatformDetector.root]):
+/// - `sys/devices/system/cpu/online`: CPUs that exist
+/// - cgroup `cpuset.cpus.effective` (v2) or `cpuset.effective_cpus` (v1),
+///   and `Cpus_allowed_list` in `proc/self/status`: CPUs allowed
+/// - `cpu*/topology/{physical_package_id,core_id}`: cores and packages
+/// - `cpu*/cache/index*/`: levels, sizes and sharing
+/// - `sys/devices/system/node/node*/cpulist`: NUMA membership
+///
+/// Only the allowed CPUs are visited, and cache attributes are read once
+/// per distinct instance, so a large host costs a few reads per allowed
+/// CPU. Other platforms get [CpuTopology.flat].
+class TopologyReader {
+  static CpuTopology? _cached;
+
+  /// Topology of the allowed CPUs, read on first use and then cached.
+  static CpuTopology read() => _cached ??= _read();
+
+  static CpuTopology _read() {
+    final platform = PlatformDetector.detectPlatform();
+    if (platform == DetectedPlatform.macOS ||
+        platform == DetectedPlatform.unsupported) {
+      return CpuTopology.flat(PlatformDetector.cpuCount());
+    }
+
+    final cpus = allowedCpus();
+    if (cpus.isEmpty) return CpuTopology.flat(PlatformDetector.cpuCount());
+
+    final cores = <String, List<int>>{};
+    final packages = <String>{};
+    final caches = <String, _CacheAccumulator>{};
+    final seenCaches = <String>{};
+    for (final cpu in cpus) {
+      final dir = '${PlatformDetector.sysCpuDir}/cpu$cpu';
+      final package = _readTrimmed('$dir/topology/physical_package_id') ?? '0';
+      final core = _readTrimmed('$dir/topology/core_id') ?? 'cpu$cpu';
+      packages.add(package);
+      cores.putIfAbsent('$package/$core', () => []).add(cpu);
+      _readCaches(dir, caches, seenCaches);
+    }
+
+    final levels = [
+      for (final accumulator in caches.values) accumulator.toCacheLevel()
+    ]..sort((a, b) => a.level != b.level
+        ? a.level.compareTo(b.level)
+        : a.type.compareTo(b.type));
+    return CpuTopology(
+      cpus: cpus,
+      cores: cores.values.toList(),
+      packages: packages.length,
+      caches: levels,
+      numaNodes: _readNumaNodes(cpus),
+    );
+  }
+
+  /// Online CPUs intersected with every available cpuset and affinity
+  /// list, ascending.
+  static List<int> allowedCpus() {
+    var allowed = _readCpuList(PlatformDetector.sysCpuOnline)?.toSet() ??
+        {for (var i = 0; i < PlatformDetector.cpuCount(); i++) i};
+
+    final cpuset = switch (PlatformDetector.detectPlatform()) {
+      DetectedPlatform.linuxCgroupV2 =>
+        _readCpuList(PlatformDetector.cgroupV2CpusetEffective),
+      DetectedPlatform.linuxCgroupV1 =>
+        _readCpuList(PlatformDetector.cgroupV1CpusetEffective),
+      _ => null,
+    };
+    if (cpuset != null) allowed = allowed.intersection(cpuset.toSet());
+
+    final affinity = _readAffinity();
+    if (affinity != null) allowed = allowed.intersection(affinity.toSet());
+
+    return allowed.toList()..sort();
+  }
+
+  /// Parses a kernel CPU list such as `0-3,8-11` into ascending ids.
+  /// Throws [FormatException] if malformed.
+  static List<int> parseCpuList(String list) {
+    final cpus = <int>[];
+    for (final range in list.trim().split(',')) {
+      if (range.isEmpty) continue;
+      final bounds = range.split('-');
+      final first = int.parse(bounds.first);
+      final last = int.parse(bounds.last);
+      for (var cpu = first; cpu <= last; cpu++) {
+        cpus.add(cpu);
+      }
+    }
+    return cpus;
+  }
+
+  static List<int>? _readCpuList(String path) {
+    try {
+      final cpus = parseCpuList(SelfStats.readFile(path));
+      return cpus.isEmpty ? null : cpus;
+    } catch (_) {}
+    return null;
+  }
+
+  /// `Cpus_allowed_list` from `/proc/self/status` (scheduler affinity).
+  static List<int>? _readAffinity() {
+    try {
+      final status = SelfStats.readFile(PlatformDetector.procSelfStatus);
+      const key = 'Cpus_allowed_list:';
+      for (final line in status.split('\n')) {
+        if (!line.startsWith(key)) continue;
+        final cpus = parseCpuList(line.substring(key.length));
+        return cpus.isEmpty ? null : cpus;
+      }
+    } catch (_) {}
+    return null;
+  }
+
+  /// Adds the caches of [cpuDir] to [into]. [seen] holds the instances
+  /// (index and sharing CPUs) already visited from another CPU, whose
+  /// attributes are not read again.
+  static void _readCaches(String cpuDir, Map<String, _CacheAccumulator> into,
+      Set<String> seen) {
+    for (var index = 0;; index++) {
+      final dir = '$cpuDir/cache/index$index';
+      final shared = _readTrimmed('$dir/shared_cpu_list');
+      if (shared == null) return;
+      if (!seen.add('$index/$shared')) continue;
+
+      final level = int.tryParse(_readTrimmed('$dir/level') ?? '');
+      final type = _readTrimmed('$dir/type');
+      final size = parseCacheSize(_readTrimmed('$dir/size') ?? '');
+      if (level == null || type == null || size == null) continue;
+
+      final accumulator = into.putIfAbsent(
+          'L$level/$type',
+          () => _CacheAccumulator(
+                level: level,
+                type: type,
+                sizeBytes: size,
+                lineBytes: int.tryParse(
+                        _readTrimmed('$dir/coherency_line_size') ?? '') ??
+                    0,
+              ));
+      accumulator.instances++;
+      final sharedBy = _countCpuList(shared);
+      if (sharedBy > accumulator.sharedByCpus) {
+        accumulator.sharedByCpus = sharedBy;
+      }
+    }
+  }
+
+  /// Parses a sysfs cache size such as `48K`, `1280K` or `32M` into bytes.
+  static int? parseCacheSize(String size) {
+    final match = RegExp(r'^(\d+)([KMG]?)$').firstMatch(size.trim());
+    if (match == null) return null;
+    final value = int.parse(match.group(1)!);
+    return switch (match.group(2)) {
+      'K' => value << 10,
+      'M' => value << 20,
+      'G' => value << 30,
+      _ => value,
+    };
+  }
+
+  static Map<int, List<int>> _readNumaNodes(List<int> cpus) {
+    final allowed = cpus.toSet();
+    final nodes = <int, List<int>>{};
+    try {
+      final dir = Directory(PlatformDetector.sysNodeDir);
+      for (final entity in dir.listSync()) {
+        final name = entity.path.substring(entity.path.lastIndexOf('/') + 1);
+        final node = name.startsWith('node')
+            ? int.tryParse(name.substring(4))
+            : null;
+        if (node == null) continue;
+
+        final members = _readCpuList('${entity.path}/cpulist')
+            ?.where(allowed.contains)
+            .toList();
+        if (members != null && members.isNotEmpty) nodes[node] = members;
+      }
+    } catch (_) {}
+    if (nodes.isEmpty) return {0: cpus};
+    return Map.fromEntries(
+        nodes.entries.toList()..sort((a, b) => a.key.compareTo(b.key)));
+  }
+
+  static int _countCpuList(String list) {
+    try {
+      return parseCpuList(list).length;
+    } catch (_) {
+      return 1;
+    }
+  }
+
+  static String? _readTrimmed(String path) {
+    try {
+      return SelfStats.readFile(path).trim();
+    } catch (_) {}
+    return null;
+  }
+
+  /// Drops the cached topology so the next [read] visits sysfs again.
+  static void clearState() => _cached = null;
+}
+
+class _CacheAccumulator {
+  final int level;
+  final String type;
+  final int sizeBytes;
+  final int lineBytes;
+  int instances = 0;
+  int sharedByCpus = 1;
+
+  _CacheAccumulator({
+    required this.level,
+    required this.type,
+    required this.sizeBytes,
+    required this.lineBytes,
+  });
+
+  CacheLevel toCacheLevel() => CacheLevel(
+        level: level,
+        type: type,
+        sizeBytes: sizeBytes,
+        lineBytes: lineBytes,
+        sharedByCpus: sharedByCpus,
+        instances: instances,
+      );
+}
@@ -0,0 +1,197 @@
+import 'quantile_sketch.dart';
+import 'resource_sampler.dart';
+import 'self_stats.dart';
+
+/// Encodes [ResourceSnapshot]s in the Prometheus text exposition format.
+///
+/// Per-tick values are emitted as gauges; rolling-window distributions are
+/// emitted as summaries with `quantile` labels (`1` is the window max).
+class ExpositionEncoder {
+  static const prefix = 'sysres';
+
+  static String encode(ResourceSnapshot snapshot) {
+    final out = StringBuffer();
+
+    _gauge(out, 'cpu_utilization_ratio',
+        'CPU usage as a fraction of the CPU limit over the last sample.',
+        snapshot.cpuUtilization);
+    _gauge(out, 'cpu_usage_millicores',
+        'CPU usage in millicores over the last sample.',
+        snapshot.cpuUsageMillicores);
+    _gauge(out, 'cpu_limit_cores', 'CPU limit in cores.',
+        snapshot.cpuLimitCores);
+    _gauge(out, 'cpu_throttled_ratio',
+        'Fraction of CFS periods throttled over the last sample.',
+        snapshot.throttledRatio);
+    _gauge(out, 'memory_used_bytes', 'Memory currently used in bytes.',
+        snapshot.memoryUsedBytes);
+    _gauge(out, 'memory_working_set_bytes',
+        'Memory used minus inactive file cache.', snapshot.workingSetBytes);
+    _gauge(out, 'memory_peak_bytes',
+        'Highest memory used since the previous sample.',
+        snapshot.memoryPeakBytes);
+    _gauge(out, 'memory_page_faults_per_second',
+        'Page faults per second (pgfault).', snapshot.pageFaultsPerSecond);
+    _gauge(out, 'memory_page_activations_per_second',
+        'Pages moved to the active LRU per second (pgactivate).',
+        snapshot.pageActivationsPerSecond);
+    _gauge(out, 'memory_page_deactivations_per_second',
+        'Pages moved to the inactive LRU per second (pgdeactivate).',
+        snapshot.pageDeactivationsPerSecond);
+    _gauge(out, 'memory_page_refills_per_second',
+        'Active pages scanned per second (pgrefill).',
+        snapshot.pageRefillsPerSecond);
+    _gauge(out, 'memory_page_scans_per_second',
+        'Inactive pages scanned by reclaim per second (pgscan).',
+        snapshot.pageScansPerSecond);
+    _gauge(out, 'memory_page_steals_per_second',
+        'Pages reclaimed per second (pgsteal).', snapshot.pageStealsPerSecond);
+    _gauge(out, 'memory_reclaim_efficiency_ratio',
+        'Pages reclaimed per page scanned.', snapshot.reclaimEfficiency);
+    _gauge(out, 'memory_limit_bytes', 'Memory limit in bytes.',
+        snapshot.memoryLimitBytes);
+    _gauge(out, 'cpu_pressure_some_avg10_ratio',
+        'PSI CPU some avg10 as a fraction.', snapshot.cpuPressure);
+    _gauge(out, 'memory_pressure_some_avg10_ratio',
+        'PSI memory some avg10 as a fraction.', snapshot.memoryPressure);
+
+    _gauge(out, 'cpu_capacity_factor_ratio',
+        'Current over maximum clock of the allowed CPUs (1 if unknown).',
+        snapshot.cpuCapacityFactor);
+    _gauge(out, 'cpu_thermal_throttle_events',
+        'Thermal throttle events over the last sample.',
+        snapshot.thermalThrottleEvents);
+
+    _gauge(out, 'network_receive_bytes_per_second',
+        'Bytes received per second on non-loopback interfaces.',
+        snapshot.networkReceiveBytesPerSecond);
+    _gauge(out, 'network_transmit_bytes_per_second',
+        'Bytes sent per second on non-loopback interfaces.',
+        snapshot.networkTransmitBytesPerSecond);
+    _gauge(out, 'tcp_retransmits_per_second',
+        'TCP segments retransmitted per second.',
+        snapshot.tcpRetransmitsPerSecond);
+    _gauge(out, 'tcp_memory_pressure_ratio',
+        'TCP buffer pages over the tcp_mem pressure threshold.',
+        snapshot.tcpMemoryPressure);
+
+    _gauge(out, 'process_open_fds', 'Open file descriptors.',
+        snapshot.openFileDescriptors);
+    if (snapshot.fileDescriptorLimit > 0) {
+      _gauge(out, 'process_max_fds', 'Soft limit on open file descriptors.',
+          snapshot.fileDescriptorLimit);
+    }
+    if (snapshot.processTreeProcesses > 0) {
+      _gauge(out, 'process_tree_processes',
+          'Live processes in this process tree.',
+          snapshot.processTreeProcesses);
+      _gauge(out, 'process_tree_cpu_usage_millicores',
+          'CPU used by this process, its descendants and reaped children.',
+          snapshot.processTreeCpuMillicores);
+      _gauge(out, 'process_tree_rss_bytes',
+          'Resident memory of this process and its descendants.',
+          snapshot.processTreeRssBytes);
+    }
+
+    _gauge(out, 'sampler_interval_seconds',
+        'Sampling interval in effect for the last sample.',
+        snapshot.samplingInterval.inMicroseconds / 1e6);
+
+    // Window distributions are time-weighted: _count is in milliseconds.
+    _summary(out, 'cpu_utilization_window_ratio',
+        'Time-weighted distribution of CPU utilization over the window.',
+        snapshot.cpuUtilizationQuantiles);
+    _summary(out, 'cpu_throttled_window_ratio',
+        'Time-weighted distribution of throttled ratio over the window.',
+        snapshot.throttledRatioQuantiles);
+    _summary(out, 'memory_working_set_window_bytes',
+        'Time-weighted distribution of working set over the window.',
+        snapshot.workingSetQuantiles);
+
+    _overhead(out, snapshot.overhead);
+
+    return out.toString();
+  }
+
+  static void _overhead(StringBuffer out, MonitoringOverhead overhead) {
+    _counter(out, 'self_samples_total', 'Sampler ticks measured.',
+        {'': overhead.samples});
+    _gauge(out, 'self_sample_min_seconds', 'Fastest sampler tick.',
+        overhead.minSampleMicros / 1e6);
+    _gauge(out, 'self_sample_avg_seconds', 'Mean sampler tick.',
+        overhead.avgSampleMicros / 1e6);
+    _gauge(out, 'self_sample_max_seconds', 'Slowest sampler tick.',
+        overhead.maxSampleMicros / 1e6);
+    _gauge(out, 'self_reads_per_sample', 'Mean source reads per tick.',
+        overhead.readsPerSample);
+    _gauge(out, 'self_syscalls_per_sample',
+        'Mean system calls issued by source reads per tick.',
+        overhead.syscallsPerSample);
+    _gauge(out, 'self_read_bytes_per_sample', 'Mean bytes read per tick.',
+        overhead.bytesPerSample);
+    _gauge(out, 'self_parse_seconds_per_sample',
+        'Mean time per tick not spent reading sources.',
+        overhead.parseMicrosPerSample / 1e6);
+
+    final sources = overhead.sources.entries.toList()
+      ..sort((a, b) => a.key.compareTo(b.key));
+    Map<String, int> bySource(int Function(SourceStats) value) => {
+          for (final MapEntry(key: source, value: stats) in sources)
+            'source="$source"': value(stats),
+        };
+    _counter(out, 'self_source_reads_total', 'Source reads attempted.',
+        bySource((stats) => stats.reads));
+    _counter(out, 'self_source_failures_total', 'Source reads that failed.',
+        bySource((stats) => stats.failures));
+    _counter(out, 'self_source_fallbacks_total',
+        'Source reads made because a preferred source was unusable.',
+        bySource((stats) => stats.fallbacks));
+    _counter(out, 'self_source_read_bytes_total', 'Bytes read per source.',
+        bySource((stats) => stats.bytes));
+    _counter(out, 'self_source_syscalls_total',
+        'System calls issued by source reads.',
+        bySource((stats) => stats.syscalls));
+  }
+
+  static void _gauge(StringBuffer out, String name, String help, num value) {
+    out
+      ..writeln('# HELP ${prefix}_$name $help')
+      ..writeln('# TYPE ${prefix}_$name gauge')
+      ..writeln('${prefix}_$name ${_format(value)}');
+  }
+
+  /// Writes a counter with one series per entry of [values], keyed by its
+  /// label set (`''` for an unlabelled series).
+  static void _counter(StringBuffer out, String name, String help,
+      Map<String, int> values) {
+    final metric = '${prefix}_$name';
+    out
+      ..writeln('# HELP $metric $help')
+      ..writeln('# TYPE $metric counter');
+    for (final MapEntry(key: labels, value: value) in values.entries) {
+      out.writeln(
+          labels.isEmpty ? '$metric $value' : '$metric{$labels} $value');
+    }
+  }
+
+  static void _summary(
+      StringBuffer out, String name, String help, QuantileSummary summary) {
+    final metric = '${prefix}_$name';
+    out
+      ..writeln('# HELP $metric $help')
+      ..writeln('# TYPE $metric summary')
+      ..writeln('$metric{quantile="0.5"} ${_format(summary.p50)}')
+      ..writeln('$metric{quantile="0.9"} ${_format(summary.p90)}')
+      ..writeln('$metric{quantile="0.99"} ${_format(summary.p99)}')
+      ..writeln('$metric{quantile="1"} ${_format(summary.max)}')
+      ..writeln('${metric}_sum ${_format(summary.sum)}')
+      ..writeln('${metric}_count ${summary.count}');
+  }
+
+  static String _format(num value) {
+    if (value is int) return value.toString();
+    if (value.isNaN) return 'NaN';
+    if (value.isInfinite) return value > 0 ? '+Inf' : '-Inf';
+    return value.toString();
+  }
+}
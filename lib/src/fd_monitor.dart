@@ -0,0 +1,117 @@
+import 'dart:io';
+
+import 'platform_detector.dart';
+import 'self_stats.dart';
+import 'ttl_cache.dart';
+
+/// Open file descriptors of this process against `RLIMIT_NOFILE`.
+class FdUsage {
+  /// Open descriptors (files, sockets, pipes, ...). 0 if unknown.
+  final int open;
+
+  /// Soft and hard `RLIMIT_NOFILE`. -1 when unlimited, 0 if unknown.
+  final int softLimit;
+  final int hardLimit;
+
+  const FdUsage({this.open = 0, this.softLimit = 0, this.hardLimit = 0});
+
+  static const unknown = FdUsage();
+
+  /// [open] as a fraction of the soft limit (0.0 if unknown or
+  /// unlimited). `accept` starts failing with `EMFILE` at 1.0.
+  double get usage => softLimit > 0 ? open / softLimit : 0.0;
+}
+
+/// Counts open descriptors without listing `/proc/self/fd` where possible.
+///
+/// Since Linux 6.2, `stat` on `/proc/self/fd` reports the number of open
+/// descriptors as the directory size: one system call whatever the count.
+/// On older kernels (size 0), and for fixture roots where the size means
+/// nothing, the directory is listed instead, which costs O(open fds).
+/// Which method works is decided on the first read.
+///
+/// Limits come from the `Max open files` line of `/proc/self/limits`.
+/// The sampler reads both every [sampleInterval], not every tick.
+class FdMonitor {
+  static const defaultSampleInterval = Duration(seconds: 10);
+
+  /// How often the sampler refreshes descriptor usage (`fdInterval` of
+  /// `SystemResources.startSampler`).
+  static Duration sampleInterval = defaultSampleInterval;
+
+  static final _cache = TtlCache<FdUsage>();
+  static bool? _statCounts;
+
+  /// Descriptor usage, at most [maxStalenessMicros] old (0 always reads).
+  static FdUsage read({int maxStalenessMicros = 0}) =>
+      _cache.get(maxStalenessMicros, _read);
+
+  /// Descriptor usage for a sampler tick, refreshed every
+  /// [sampleInterval].
+  static FdUsage sample() =>
+      read(maxStalenessMicros: sampleInterval.inMicroseconds);
+
+  static FdUsage _read() {
+    final platform = PlatformDetector.detectPlatform();
+    if (platform == DetectedPlatform.macOS ||
+        platform == DetectedPlatform.unsupported) {
+      return FdUsage.unknown;
+    }
+    final (soft, hard) = _readLimits();
+    return FdUsage(open: _countOpen(), softLimit: soft, hardLimit: hard);
+  }
+
+  static int _countOpen() {
+    final path = PlatformDetector.procSelfFd;
+    final rooted = PlatformDetector.root.isNotEmpty;
+
+    if (!rooted && _statCounts != false) {
+      final start = SelfStats.nowMicros();
+      final size = FileStat.statSync(path).size;
+      SelfStats.count(path, syscalls: 1, startMicros: start, failed: size < 0);
+      _statCounts = size > 0;
+      if (size > 0) return size;
+    }
+
+    final start = SelfStats.nowMicros();
+    try {
+      final count = Directory(path).listSync(followLinks: false).length;
+      // open, close and roughly one getdents64 per thousand entries.
+      SelfStats.count(path, syscalls: 3 + count ~/ 1000, startMicros: start);
+      // The listing's own descriptor is among those listed.
+      return rooted || count == 0 ? count : count - 1;
+    } catch (_) {
+      SelfStats.count(path, syscalls: 1, startMicros: start, failed: true);
+      return 0;
+    }
+  }
+
+  /// Soft and hard limit from `Max open files  1024  1048576  files`.
+  static (int, int) _readLimits() {
+    try {
+      final limits = SelfStats.readFile(PlatformDetector.procSelfLimits);
+      const key = 'Max open files';
+      final start = limits.indexOf(key);
+      if (start < 0) return (0, 0);
+      final end = limits.indexOf('\n', start);
+      final fields = limits
+          .substring(start + key.length, end < 0 ? limits.length : end)
+          .trim()
+          .split(RegExp(r'\s+'));
+      if (fields.length < 2) return (0, 0);
+      return (_parseLimit(fields[0]), _parseLimit(fields[1]));
+    } catch (_) {}
+    return (0, 0);
+  }
+
+  static int _parseLimit(String value) =>
+      value == 'unlimited' ? -1 : int.tryParse(value) ?? 0;
+
+  /// Drops the cached usage and counting method and restores the default
+  /// [sampleInterval]. Useful for testing.
+  static void clearState() {
+    _cache.clear();
+    _statCounts = null;
+    sampleInterval = defaultSampleInterval;
+  }
+}
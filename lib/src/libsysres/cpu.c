@@ -1,4 +1,5 @@
 #include "sysres.h"
+#include "sysres_internal.h"
 
 // Linux
 #if __unix__
@@ -6,6 +7,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <sys/sysinfo.h>
 
 /*
@@ -18,21 +22,32 @@
  *
  * For gVisor environments (which don't expose cgroups):
  * Set SYSRES_CPU_CORES environment variable to override.
+ *
+ * Limit inputs are kept off the per-sample path:
+ * - SYSRES_CPU_CORES is parsed once (pthread_once).
+ * - cpu.max and the online CPU count are cached and re-read at most once
+ *   per LIMITS_TTL_NS, so an in-place resize is seen within a second, or
+ *   on next use after sysres_invalidate_limits() signals a change.
  */
 
+/* How long cached limit inputs are used before they are re-read */
+#define LIMITS_TTL_NS 1000000000LL
+
+static pthread_once_t env_once = PTHREAD_ONCE_INIT;
+static float env_cpu_limit = -1.0f;
+
+/* Bumped by sysres_invalidate_limits(); cache is valid while equal. */
+static atomic_uint limits_generation = 1;
+static atomic_uint cached_generation = 0;
+static _Atomic float cached_cgroup_limit = -1.0f;
+static atomic_int cached_nprocs = 1;
+static atomic_llong cached_ns = 0;
+
 /* Get CPU limit from cgroups v2. Returns -1 if not available or unlimited. */
 static float get_cgroup_cpu_limit()
 {
-	FILE *fd = fopen("/sys/fs/cgroup/cpu.max", "r");
-	if (fd == NULL)
-	{
-		return -1.0f;
-	}
-
-	char buff[64] = {0};
-	size_t len = fread(buff, 1, sizeof(buff) - 1, fd);
-	fclose(fd);
-
+	char buff[64];
+	size_t len = sysres_read_file(SYSRES_SOURCE_CPU_MAX, "/sys/fs/cgroup/cpu.max", buff, sizeof(buff));
 	if (len == 0)
 	{
 		return -1.0f;
@@ -47,69 +62,172 @@ static float get_cgroup_cpu_limit()
 	/* Parse "quota period" format */
 	long long quota = 0;
 	long long period = 0;
-	if (sscanf(buff, "%lld %lld", &quota, &period) != 2)
+	if (sscanf(buff, "%lld %lld", &quota, &period) != 2 || period <= 0)
 	{
+		sysres_parse_failed(SYSRES_SOURCE_CPU_MAX);
 		return -1.0f;
 	}
 
-	if (period <= 0)
+	return (float)quota / (float)period;
+}
+
+/*
+ * Online CPU count. Under a fake root, counts the CPU list in
+ * sys/devices/system/cpu/online (e.g. "0-3,8-11") so fixture hosts can
+ * differ from the machine running them.
+ */
+static int get_online_cpus()
+{
+	if (!sysres_is_rooted())
 	{
-		return -1.0f;
+		return get_nprocs();
 	}
 
-	return (float)quota / (float)period;
+	char buff[256];
+	size_t len = sysres_read_file(SYSRES_SOURCE_CPU_ONLINE, "/sys/devices/system/cpu/online", buff, sizeof(buff));
+
+	int count = 0;
+	char *cursor = buff;
+	while (len > 0 && *cursor != '\0' && *cursor != '\n')
+	{
+		char *end;
+		long first = strtol(cursor, &end, 10);
+		if (end == cursor)
+		{
+			break;
+		}
+		long last = first;
+		if (*end == '-')
+		{
+			cursor = end + 1;
+			last = strtol(cursor, &end, 10);
+		}
+		count += (int)(last - first + 1);
+		cursor = (*end == ',') ? end + 1 : end;
+	}
+
+	if (count <= 0)
+	{
+		sysres_parse_failed(SYSRES_SOURCE_CPU_ONLINE);
+		return get_nprocs();
+	}
+	return count;
 }
 
-/* Get CPU limit from environment variable (for gVisor). Returns -1 if not set. */
-static float get_env_cpu_limit()
+/* Parse SYSRES_CPU_CORES once (for gVisor). Leaves -1 if not set. */
+static void init_env_cpu_limit()
 {
 	const char *env_val = getenv("SYSRES_CPU_CORES");
 	if (env_val == NULL)
 	{
-		return -1.0f;
+		return;
 	}
 
 	float cores = strtof(env_val, NULL);
-	if (cores <= 0)
+	if (cores > 0)
 	{
-		return -1.0f;
+		env_cpu_limit = cores;
 	}
+}
 
-	return cores;
+/* Cached cgroup limit in millicores, -1 if unlimited */
+static long long millicores(float cores)
+{
+	return cores > 0 ? (long long)(cores * 1000.0f + 0.5f) : -1;
 }
 
-float get_cpu_limit_cores()
+/* Re-read sysfs-derived inputs if a change was signalled or they expired. */
+static void refresh_cpu_limits()
 {
+	unsigned int generation = atomic_load_explicit(&limits_generation, memory_order_acquire);
+	long long now = sysres_now_ns();
+	if (atomic_load_explicit(&cached_generation, memory_order_acquire) == generation &&
+		now - atomic_load_explicit(&cached_ns, memory_order_relaxed) < LIMITS_TTL_NS)
+	{
+		return;
+	}
+
+	/* Concurrent refreshes store the same values, so no lock is needed. */
+	int nprocs = get_online_cpus();
+	nprocs = nprocs > 0 ? nprocs : 1;
+	float limit = get_cgroup_cpu_limit();
+	int old_nprocs = atomic_exchange_explicit(&cached_nprocs, nprocs, memory_order_relaxed);
+	float old_limit = atomic_exchange_explicit(&cached_cgroup_limit, limit, memory_order_relaxed);
+	int first = atomic_load_explicit(&cached_generation, memory_order_relaxed) == 0;
+	atomic_store_explicit(&cached_ns, now, memory_order_relaxed);
+	atomic_store_explicit(&cached_generation, generation, memory_order_release);
+
+	if (!first && old_nprocs != nprocs)
+	{
+		sysres_limit_changed("cpu_online", old_nprocs, nprocs);
+	}
+	if (!first && old_limit != limit)
+	{
+		sysres_limit_changed("cpu.max", millicores(old_limit), millicores(limit));
+	}
+}
+
+void sysres_invalidate_limits()
+{
+	atomic_fetch_add_explicit(&limits_generation, 1, memory_order_acq_rel);
+}
+
+static float cpu_limit_cores()
+{
+	pthread_once(&env_once, init_env_cpu_limit);
+
 	/* Priority 1: Environment variable (for gVisor) */
-	float env_limit = get_env_cpu_limit();
-	if (env_limit > 0)
+	if (env_cpu_limit > 0)
 	{
-		return env_limit;
+		return env_cpu_limit;
 	}
 
+	refresh_cpu_limits();
+
 	/* Priority 2: cgroups v2 */
-	float cgroup_limit = get_cgroup_cpu_limit();
+	float cgroup_limit = atomic_load_explicit(&cached_cgroup_limit, memory_order_relaxed);
 	if (cgroup_limit > 0)
 	{
 		return cgroup_limit;
 	}
 
 	/* Fallback: host CPU count */
-	return (float)get_nprocs();
+	return (float)atomic_load_explicit(&cached_nprocs, memory_order_relaxed);
+}
+
+float get_cpu_limit_cores()
+{
+	long long start = sysres_stats_begin("get_cpu_limit_cores");
+	float cores = cpu_limit_cores();
+	sysres_stats_end("get_cpu_limit_cores", start);
+	return cores;
 }
 
 float get_cpu_load()
 {
-	double load[1] = {0};
-	getloadavg(load, 1);
+	long long start = sysres_stats_begin("get_cpu_load");
 
-	float cpu_limit = get_cpu_limit_cores();
-	if (cpu_limit <= 0)
+	/*
+	 * The 1-minute average from /proc/loadavg, read directly rather than
+	 * through getloadavg() so that a root set by sysres_set_root applies.
+	 */
+	char buff[128];
+	double load = 0;
+	if (sysres_read_file(SYSRES_SOURCE_LOADAVG, "/proc/loadavg", buff, sizeof(buff)) > 0)
 	{
-		cpu_limit = (float)get_nprocs();
+		char *end;
+		load = strtod(buff, &end);
+		if (end == buff)
+		{
+			sysres_parse_failed(SYSRES_SOURCE_LOADAVG);
+			load = 0;
+		}
 	}
 
-	return (float)load[0] / cpu_limit;
+	/* Never <= 0: falls back to the cached online CPU count */
+	float cpu_load = (float)load / cpu_limit_cores();
+	sysres_stats_end("get_cpu_load", start);
+	return cpu_load;
 }
 
 #endif
@@ -117,6 +235,7 @@ float get_cpu_load()
 #if __MACH__
 
 #include <stdlib.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <sys/sysctl.h>
 
@@ -125,24 +244,54 @@ float get_cpu_load()
  * These functions always return host values.
  */
 
-static int get_macos_cpu_count()
+static pthread_once_t cpu_count_once = PTHREAD_ONCE_INIT;
+static int macos_cpu_count = 1;
+
+static void init_macos_cpu_count()
 {
-	int thread_count;
+	long long start = sysres_now_ns();
+	int thread_count = 0;
 	size_t len = sizeof(thread_count);
-	sysctlbyname("machdep.cpu.thread_count", &thread_count, &len, NULL, 0);
-	return thread_count;
+	int failed = sysctlbyname("machdep.cpu.thread_count", &thread_count, &len, NULL, 0) != 0;
+	sysres_count_read(SYSRES_SOURCE_SYSCTL, failed, (long long)len, 1, sysres_now_ns() - start);
+	if (!failed && thread_count > 0)
+	{
+		macos_cpu_count = thread_count;
+	}
+}
+
+/* The thread count cannot change at runtime; read it once. */
+static int get_macos_cpu_count()
+{
+	pthread_once(&cpu_count_once, init_macos_cpu_count);
+	return macos_cpu_count;
+}
+
+void sysres_invalidate_limits()
+{
+	/* Nothing is cached that can change at runtime on macOS */
 }
 
 float get_cpu_limit_cores()
 {
-	return (float)get_macos_cpu_count();
+	long long start = sysres_stats_begin("get_cpu_limit_cores");
+	float cores = (float)get_macos_cpu_count();
+	sysres_stats_end("get_cpu_limit_cores", start);
+	return cores;
 }
 
 float get_cpu_load()
 {
+	long long start = sysres_stats_begin("get_cpu_load");
+
+	/* One sysctl(vm.loadavg) */
 	double load[1] = {0};
-	getloadavg(load, 1);
-	return load[0] / get_macos_cpu_count();
+	int failed = getloadavg(load, 1) < 1;
+	sysres_count_read(SYSRES_SOURCE_LOADAVG, failed, 0, 1, sysres_now_ns() - start);
+
+	float cpu_load = load[0] / get_macos_cpu_count();
+	sysres_stats_end("get_cpu_load", start);
+	return cpu_load;
 }
 
 #endif
@@ -1,12 +1,14 @@
 #include "sysres.h"
+#include "sysres_internal.h"
 
 // Linux
 #if __unix__
 
-#include <stdio.h>
 #include <unistd.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
+#include <stdatomic.h>
 
 /*
  * Container-aware memory functions using cgroups v2.
@@ -18,8 +20,26 @@
  *
  * Note: gVisor virtualizes /proc/meminfo to show container limits,
  * so the fallback works correctly in gVisor environments.
+ *
+ * The source is chosen by probing memory.max and kept in a backend table,
+ * so readers make one indirect call. The choice is trusted for
+ * BACKEND_TTL_NS, after which memory.max is probed again, so a limit
+ * applied later is picked up. The cgroup backend reads memory.max for
+ * the limit anyway and switches to /proc/meminfo as soon as the limit is
+ * removed. Changing the root (sysres_set_root) selects again.
  */
 
+/* How long a backend selection is used before memory.max is probed again */
+#define BACKEND_TTL_NS 1000000000LL
+
+struct memory_backend
+{
+	long long (*limit_bytes)();
+	long long (*used_bytes)();
+	/* Batch read: both values in as few file reads as possible */
+	void (*read)(long long *limit, long long *used);
+};
+
 static long long get_entry(const char *name, const char *buff)
 {
 	char *hit = strstr(buff, name);
@@ -32,18 +52,10 @@ static long long get_entry(const char *name, const char *buff)
 }
 
 /* Read a single value from a cgroup file. Returns -1 on failure or if "max". */
-static long long read_cgroup_value(const char *path)
+static long long read_cgroup_value(int source, const char *path)
 {
-	FILE *fd = fopen(path, "r");
-	if (fd == NULL)
-	{
-		return -1;
-	}
-
-	char buff[64] = {0};
-	size_t len = fread(buff, 1, sizeof(buff) - 1, fd);
-	fclose(fd);
-
+	char buff[64];
+	size_t len = sysres_read_file(source, path, buff, sizeof(buff));
 	if (len == 0)
 	{
 		return -1;
@@ -55,26 +67,21 @@ static long long read_cgroup_value(const char *path)
 		return -1;
 	}
 
-	return strtoll(buff, NULL, 10);
+	char *end;
+	long long value = strtoll(buff, &end, 10);
+	if (end == buff)
+	{
+		sysres_parse_failed(source);
+		return -1;
+	}
+	return value;
 }
 
 /* Get memory info from /proc/meminfo (host or gVisor virtualized) */
 static void get_proc_meminfo(long long *total, long long *used)
 {
-	FILE *fd;
-	char buff[4096] = {0};
-
-	fd = fopen("/proc/meminfo", "r");
-	if (fd == NULL)
-	{
-		*total = 0;
-		*used = 0;
-		return;
-	}
-
-	size_t len = fread(buff, 1, sizeof(buff) - 1, fd);
-	fclose(fd);
-
+	char buff[4096];
+	size_t len = sysres_read_file(SYSRES_SOURCE_MEMINFO, "/proc/meminfo", buff, sizeof(buff));
 	if (len == 0)
 	{
 		*total = 0;
@@ -87,6 +94,10 @@ static void get_proc_meminfo(long long *total, long long *used)
 	long long free_kb = get_entry("MemFree:", buff);
 	long long buffers_kb = get_entry("Buffers:", buff);
 	long long cached_kb = get_entry("Cached:", buff);
+	if (total_kb <= 0)
+	{
+		sysres_parse_failed(SYSRES_SOURCE_MEMINFO);
+	}
 
 	*total = total_kb * 1024;  /* Convert to bytes */
 	*used = (total_kb - free_kb - buffers_kb - cached_kb) * 1024;
@@ -95,52 +106,158 @@ static void get_proc_meminfo(long long *total, long long *used)
 /* Check if running in a container with cgroups v2 memory limits */
 static int has_cgroup_memory_limit()
 {
-	long long limit = read_cgroup_value("/sys/fs/cgroup/memory.max");
+	long long limit = read_cgroup_value(SYSRES_SOURCE_MEMORY_MAX, "/sys/fs/cgroup/memory.max");
 	return limit > 0;
 }
 
-int is_container_env()
+/* Last memory.max seen by read_memory_max, -1 if unlimited, 0 if none */
+static atomic_llong last_memory_limit = 0;
+
+/* NULL until selected; concurrent selections store equivalent pointers */
+static _Atomic(const struct memory_backend *) backend = NULL;
+static atomic_llong selected_ns = 0;
+
+static void use_backend(const struct memory_backend *selected)
 {
-	return has_cgroup_memory_limit();
+	atomic_store_explicit(&selected_ns, sysres_now_ns(), memory_order_relaxed);
+	atomic_store_explicit(&backend, selected, memory_order_release);
 }
 
-long long get_memory_limit_bytes()
+/* memory.max in bytes, or -1 if unlimited or missing; reports changes */
+static long long read_memory_max()
+{
+	long long limit = read_cgroup_value(SYSRES_SOURCE_MEMORY_MAX, "/sys/fs/cgroup/memory.max");
+	long long seen = limit > 0 ? limit : -1;
+	long long last = atomic_load_explicit(&last_memory_limit, memory_order_relaxed);
+	if (last != seen)
+	{
+		atomic_store_explicit(&last_memory_limit, seen, memory_order_relaxed);
+		if (last != 0)
+		{
+			sysres_limit_changed("memory.max", last, seen);
+		}
+	}
+	return limit > 0 ? limit : -1;
+}
+
+static const struct memory_backend proc_backend;
+
+static long long cgroup_limit_bytes()
 {
-	/* Try cgroups v2 first */
-	long long cgroup_limit = read_cgroup_value("/sys/fs/cgroup/memory.max");
-	if (cgroup_limit > 0)
+	long long limit = read_memory_max();
+	if (limit > 0)
 	{
-		return cgroup_limit;
+		return limit;
 	}
 
-	/* Fall back to /proc/meminfo (works for host and gVisor) */
+	/* Limit removed since selection: report host memory from now on */
+	use_backend(&proc_backend);
 	long long total, used;
+	sysres_count_fallback(SYSRES_SOURCE_MEMINFO);
 	get_proc_meminfo(&total, &used);
 	return total;
 }
 
-long long get_memory_used_bytes()
+static long long cgroup_used_bytes()
 {
-	/* Try cgroups v2 first */
-	if (has_cgroup_memory_limit())
+	long long current = read_cgroup_value(SYSRES_SOURCE_MEMORY_CURRENT, "/sys/fs/cgroup/memory.current");
+	if (current >= 0)
 	{
-		long long current = read_cgroup_value("/sys/fs/cgroup/memory.current");
-		if (current >= 0)
-		{
-			return current;
-		}
+		return current;
+	}
+
+	long long total, used;
+	sysres_count_fallback(SYSRES_SOURCE_MEMINFO);
+	get_proc_meminfo(&total, &used);
+	return used;
+}
+
+static void cgroup_read(long long *limit, long long *used)
+{
+	*limit = read_memory_max();
+	if (*limit > 0)
+	{
+		*used = cgroup_used_bytes();
+		return;
 	}
 
-	/* Fall back to /proc/meminfo calculation */
+	/* Limit removed: usage and limit both from /proc/meminfo, as on a host */
+	use_backend(&proc_backend);
+	sysres_count_fallback(SYSRES_SOURCE_MEMINFO);
+	get_proc_meminfo(limit, used);
+}
+
+static long long proc_limit_bytes()
+{
+	long long total, used;
+	get_proc_meminfo(&total, &used);
+	return total;
+}
+
+static long long proc_used_bytes()
+{
 	long long total, used;
 	get_proc_meminfo(&total, &used);
 	return used;
 }
 
+static const struct memory_backend cgroup_v2_backend = {
+	cgroup_limit_bytes, cgroup_used_bytes, cgroup_read};
+
+/* Host and gVisor: one /proc/meminfo read serves both values */
+static const struct memory_backend proc_backend = {
+	proc_limit_bytes, proc_used_bytes, get_proc_meminfo};
+
+static const struct memory_backend *get_backend()
+{
+	const struct memory_backend *selected = atomic_load_explicit(&backend, memory_order_acquire);
+	long long age = sysres_now_ns() - atomic_load_explicit(&selected_ns, memory_order_relaxed);
+	if (selected != NULL && age < BACKEND_TTL_NS)
+	{
+		return selected;
+	}
+
+	selected = has_cgroup_memory_limit() ? &cgroup_v2_backend : &proc_backend;
+	use_backend(selected);
+	return selected;
+}
+
+void sysres_reset_memory_backend()
+{
+	atomic_store_explicit(&backend, NULL, memory_order_release);
+	atomic_store_explicit(&last_memory_limit, 0, memory_order_relaxed);
+}
+
+int is_container_env()
+{
+	long long start = sysres_stats_begin("is_container_env");
+	int container = get_backend() == &cgroup_v2_backend;
+	sysres_stats_end("is_container_env", start);
+	return container;
+}
+
+long long get_memory_limit_bytes()
+{
+	long long start = sysres_stats_begin("get_memory_limit_bytes");
+	long long limit = get_backend()->limit_bytes();
+	sysres_stats_end("get_memory_limit_bytes", start);
+	return limit;
+}
+
+long long get_memory_used_bytes()
+{
+	long long start = sysres_stats_begin("get_memory_used_bytes");
+	long long used = get_backend()->used_bytes();
+	sysres_stats_end("get_memory_used_bytes", start);
+	return used;
+}
+
 float get_memory_usage()
 {
-	long long limit = get_memory_limit_bytes();
-	long long used = get_memory_used_bytes();
+	long long start = sysres_stats_begin("get_memory_usage");
+	long long limit, used;
+	get_backend()->read(&limit, &used);
+	sysres_stats_end("get_memory_usage", start);
 
 	if (limit <= 0)
 	{
@@ -173,13 +290,17 @@ static void get_macos_memory(long long *total, long long *used)
 	mach_msg_type_number_t count;
 	vm_statistics64_data_t vm_stats;
 
+	long long start = sysres_now_ns();
 	mach_port = mach_host_self();
 	count = sizeof(vm_stats) / sizeof(natural_t);
 
 	*used = 0;
 	*total = 0;
 
-	if (KERN_SUCCESS == host_page_size(mach_port, &page_size) && KERN_SUCCESS == host_statistics64(mach_port, HOST_VM_INFO, (host_info64_t)&vm_stats, &count))
+	/* mach_host_self, host_page_size and host_statistics64 are Mach traps */
+	int ok = KERN_SUCCESS == host_page_size(mach_port, &page_size) && KERN_SUCCESS == host_statistics64(mach_port, HOST_VM_INFO, (host_info64_t)&vm_stats, &count);
+	sysres_count_read(SYSRES_SOURCE_HOST_STATISTICS, !ok, ok ? (long long)sizeof(vm_stats) : 0, 3, sysres_now_ns() - start);
+	if (ok)
 	{
 		long long free_memory = (int64_t)vm_stats.free_count * (int64_t)page_size;
 		*used = ((int64_t)vm_stats.active_count + (int64_t)vm_stats.inactive_count + (int64_t)vm_stats.wire_count) * (int64_t)page_size;
@@ -195,22 +316,28 @@ int is_container_env()
 
 long long get_memory_limit_bytes()
 {
+	long long start = sysres_stats_begin("get_memory_limit_bytes");
 	long long total, used;
 	get_macos_memory(&total, &used);
+	sysres_stats_end("get_memory_limit_bytes", start);
 	return total;
 }
 
 long long get_memory_used_bytes()
 {
+	long long start = sysres_stats_begin("get_memory_used_bytes");
 	long long total, used;
 	get_macos_memory(&total, &used);
+	sysres_stats_end("get_memory_used_bytes", start);
 	return used;
 }
 
 float get_memory_usage()
 {
+	long long start = sysres_stats_begin("get_memory_usage");
 	long long total, used;
 	get_macos_memory(&total, &used);
+	sysres_stats_end("get_memory_usage", start);
 
 	if (total == 0)
 	{
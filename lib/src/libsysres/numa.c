@@ -0,0 +1,165 @@
+#include "sysres.h"
+#include "sysres_internal.h"
+
+// Linux
+#if __unix__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * NUMA memory per node.
+ *
+ * Files used:
+ * - /sys/devices/system/node/online         (node list, e.g. "0-1")
+ * - /sys/devices/system/node/nodeN/meminfo  ("Node N MemTotal: ... kB")
+ * - /sys/devices/system/node/nodeN/numastat (numa_hit, numa_miss, ...)
+ * - /sys/fs/cgroup/memory.numa_stat         ("anon N0=... N1=..." bytes)
+ *
+ * Nothing is cached: usage and counters change on every read. A call
+ * costs two reads plus two per node.
+ */
+
+/* Value following name in buff, 0 if absent */
+static long long find_value(const char *buff, const char *name)
+{
+	const char *hit = strstr(buff, name);
+	return hit == NULL ? 0 : strtoll(hit + strlen(name), NULL, 10);
+}
+
+/*
+ * Value for node in the "N<node>=" field of the line starting with key in
+ * a memory.numa_stat file. Returns -1 if absent.
+ */
+static long long numa_stat_value(const char *buff, const char *key, long long node)
+{
+	size_t key_len = strlen(key);
+	const char *line = buff;
+	while (line != NULL && *line != '\0')
+	{
+		if (strncmp(line, key, key_len) == 0 && line[key_len] == ' ')
+		{
+			char field[32];
+			snprintf(field, sizeof(field), " N%lld=", node);
+			const char *end = strchr(line, '\n');
+			const char *hit = strstr(line, field);
+			if (hit == NULL || (end != NULL && hit > end))
+			{
+				return -1;
+			}
+			return strtoll(hit + strlen(field), NULL, 10);
+		}
+		line = strchr(line, '\n');
+		line = line == NULL ? NULL : line + 1;
+	}
+	return -1;
+}
+
+static void read_node(struct sysres_numa_node *node, const char *numa_stat)
+{
+	char path[96];
+	char buff[4096];
+
+	snprintf(path, sizeof(path), "/sys/devices/system/node/node%lld/meminfo", node->node);
+	size_t len = sysres_read_file(SYSRES_SOURCE_NODE_MEMINFO, path, buff, sizeof(buff));
+	long long anon_kb = 0;
+	long long file_kb = 0;
+	if (len > 0)
+	{
+		/* Values in node meminfo are in kB */
+		node->total_bytes = find_value(buff, "MemTotal:") * 1024;
+		node->free_bytes = find_value(buff, "MemFree:") * 1024;
+		anon_kb = find_value(buff, "AnonPages:");
+		file_kb = find_value(buff, "FilePages:");
+		if (node->total_bytes == 0)
+		{
+			sysres_parse_failed(SYSRES_SOURCE_NODE_MEMINFO);
+		}
+	}
+
+	snprintf(path, sizeof(path), "/sys/devices/system/node/node%lld/numastat", node->node);
+	len = sysres_read_file(SYSRES_SOURCE_NUMASTAT, path, buff, sizeof(buff));
+	if (len > 0)
+	{
+		node->numa_hit = find_value(buff, "numa_hit ");
+		node->numa_miss = find_value(buff, "numa_miss ");
+		node->numa_foreign = find_value(buff, "numa_foreign ");
+		node->local_node = find_value(buff, "local_node ");
+		node->other_node = find_value(buff, "other_node ");
+	}
+
+	long long anon = numa_stat != NULL ? numa_stat_value(numa_stat, "anon", node->node) : -1;
+	long long file = numa_stat != NULL ? numa_stat_value(numa_stat, "file", node->node) : -1;
+	if (anon >= 0 && file >= 0)
+	{
+		node->cgroup_scoped = 1;
+		node->anon_bytes = anon;
+		node->file_bytes = file;
+	}
+	else
+	{
+		node->anon_bytes = anon_kb * 1024;
+		node->file_bytes = file_kb * 1024;
+	}
+}
+
+int get_numa_nodes(struct sysres_numa_node *nodes, int max_nodes)
+{
+	long long start = sysres_stats_begin("get_numa_nodes");
+
+	char online[256];
+	size_t len = sysres_read_file(SYSRES_SOURCE_NODE_ONLINE, "/sys/devices/system/node/online", online, sizeof(online));
+
+	/* memory.numa_stat grows with the node count; 16 KiB covers 64 nodes */
+	char numa_stat[16384];
+	const char *cgroup_stat = NULL;
+	if (len > 0 && sysres_read_file(SYSRES_SOURCE_MEMORY_NUMA_STAT, "/sys/fs/cgroup/memory.numa_stat", numa_stat, sizeof(numa_stat)) > 0)
+	{
+		cgroup_stat = numa_stat;
+	}
+
+	int count = 0;
+	char *cursor = online;
+	while (len > 0 && count < max_nodes && *cursor != '\0' && *cursor != '\n')
+	{
+		char *end;
+		long first = strtol(cursor, &end, 10);
+		if (end == cursor)
+		{
+			sysres_parse_failed(SYSRES_SOURCE_NODE_ONLINE);
+			break;
+		}
+		long last = first;
+		if (*end == '-')
+		{
+			cursor = end + 1;
+			last = strtol(cursor, &end, 10);
+		}
+		for (long id = first; id <= last && count < max_nodes; id++)
+		{
+			struct sysres_numa_node *node = &nodes[count++];
+			memset(node, 0, sizeof(*node));
+			node->node = id;
+			read_node(node, cgroup_stat);
+		}
+		cursor = (*end == ',') ? end + 1 : end;
+	}
+
+	sysres_stats_end("get_numa_nodes", start);
+	return count;
+}
+
+#endif
+
+#if __MACH__
+
+/* macOS has no NUMA nodes */
+int get_numa_nodes(struct sysres_numa_node *nodes, int max_nodes)
+{
+	(void)nodes;
+	(void)max_nodes;
+	return 0;
+}
+
+#endif
@@ -0,0 +1,279 @@
+#include "sysres.h"
+#include "sysres_internal.h"
+
+#include <stddef.h>
+#include <string.h>
+
+// Linux
+#if __unix__ && !defined(SYSRES_NO_PERF)
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/*
+ * Process-wide perf_event counter groups.
+ *
+ * Each group has a leader and members opened with group_fd = leader, so
+ * the kernel schedules them together and one read(2) on the leader with
+ * PERF_FORMAT_GROUP returns every value plus the enabled/running times:
+ *
+ *   u64 nr; u64 time_enabled; u64 time_running; u64 values[nr];
+ *
+ * Members the PMU does not support (ENOENT, EOPNOTSUPP) are left out and
+ * reported as -1. If the leader cannot be opened the whole group is.
+ * Context switches happen in the kernel, so a software group limited to
+ * user space never counts one; they are reported as -1 then too.
+ */
+
+enum
+{
+	MAX_MEMBERS = 5
+};
+
+struct perf_event
+{
+	unsigned int type;
+	unsigned long long config;
+	size_t offset; /* field in struct sysres_perf_counters */
+};
+
+struct perf_group
+{
+	int count;                  /* events opened, leader first; 0 if not open */
+	int fds[MAX_MEMBERS];       /* fds[0] is the leader */
+	size_t offset[MAX_MEMBERS]; /* field of each value, in read order */
+	int exclude_kernel;         /* user-space events only */
+};
+
+static const struct perf_event hardware_events[] = {
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, offsetof(struct sysres_perf_counters, cycles)},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, offsetof(struct sysres_perf_counters, instructions)},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES, offsetof(struct sysres_perf_counters, cache_references)},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, offsetof(struct sysres_perf_counters, cache_misses)},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, offsetof(struct sysres_perf_counters, branch_misses)},
+};
+
+static const struct perf_event software_events[] = {
+	{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, offsetof(struct sysres_perf_counters, task_clock_ns)},
+	{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, offsetof(struct sysres_perf_counters, page_faults)},
+	{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, offsetof(struct sysres_perf_counters, context_switches)},
+};
+
+#define EVENT_COUNT(events) ((int)(sizeof(events) / sizeof((events)[0])))
+
+static struct perf_group hardware;
+static struct perf_group software;
+
+static int perf_event_open(const struct perf_event *event, int group_fd, int exclude_kernel)
+{
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = event->type;
+	attr.config = event->config;
+	attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	attr.inherit = 1;
+	attr.exclude_kernel = exclude_kernel;
+	attr.exclude_hv = 1;
+	/* The leader starts disabled and enables the whole group at once */
+	attr.disabled = group_fd == -1;
+
+	/* pid 0, cpu -1: this process on any CPU */
+	return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+
+static void close_group(struct perf_group *group)
+{
+	for (int i = 0; i < group->count; i++)
+	{
+		close(group->fds[i]);
+	}
+	group->count = 0;
+}
+
+/* Returns 0, or the negated errno of the leader or of starting the group */
+static int open_group(struct perf_group *group, const struct perf_event *events, int count, int exclude_kernel)
+{
+	int leader = perf_event_open(&events[0], -1, exclude_kernel);
+	if (leader < 0)
+	{
+		return -errno;
+	}
+	group->fds[0] = leader;
+	group->offset[0] = events[0].offset;
+	group->count = 1;
+	group->exclude_kernel = exclude_kernel;
+
+	for (int i = 1; i < count; i++)
+	{
+		int fd = perf_event_open(&events[i], leader, exclude_kernel);
+		if (fd >= 0)
+		{
+			group->fds[group->count] = fd;
+			group->offset[group->count] = events[i].offset;
+			group->count++;
+		}
+	}
+
+	if (ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP) < 0 ||
+		ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) < 0)
+	{
+		int error = errno;
+		close_group(group);
+		return -error;
+	}
+	return 0;
+}
+
+void sysres_perf_close()
+{
+	close_group(&hardware);
+	close_group(&software);
+}
+
+int sysres_perf_open()
+{
+	long long start = sysres_stats_begin("sysres_perf_open");
+	sysres_perf_close();
+
+	/* User space only: allowed up to perf_event_paranoid 2, and where IPC matters */
+	open_group(&hardware, hardware_events, EVENT_COUNT(hardware_events), 1);
+
+	/* Context switches are kernel events; count them if allowed */
+	int error = open_group(&software, software_events, EVENT_COUNT(software_events), 0);
+	if (error == -EACCES || error == -EPERM)
+	{
+		open_group(&software, software_events, EVENT_COUNT(software_events), 1);
+	}
+
+	sysres_stats_end("sysres_perf_open", start);
+	if (hardware.count > 0)
+	{
+		return SYSRES_PERF_HARDWARE;
+	}
+	return software.count > 0 ? SYSRES_PERF_SOFTWARE : SYSRES_PERF_NONE;
+}
+
+/* Reads group into counters; sets the enabled/running times */
+static void read_group(const struct perf_group *group, struct sysres_perf_counters *counters)
+{
+	if (group->count == 0)
+	{
+		return;
+	}
+
+	unsigned long long buff[3 + MAX_MEMBERS];
+	long long start = sysres_now_ns();
+	ssize_t len = read(group->fds[0], buff, sizeof(buff));
+	int ok = len >= (ssize_t)((3 + group->count) * sizeof(buff[0])) && buff[0] == (unsigned long long)group->count;
+	sysres_count_read(SYSRES_SOURCE_PERF_EVENT, len <= 0, len > 0 ? len : 0, 1, sysres_now_ns() - start);
+	if (!ok)
+	{
+		if (len > 0)
+		{
+			sysres_parse_failed(SYSRES_SOURCE_PERF_EVENT);
+		}
+		return;
+	}
+
+	counters->time_enabled_ns = (long long)buff[1];
+	counters->time_running_ns = (long long)buff[2];
+	/* Multiplexed: extrapolate to the whole enabled time */
+	double scale = buff[2] > 0 && buff[2] < buff[1] ? (double)buff[1] / (double)buff[2] : 1.0;
+	for (int i = 0; i < group->count; i++)
+	{
+		long long *value = (long long *)((char *)counters + group->offset[i]);
+		*value = (long long)((double)buff[3 + i] * scale);
+	}
+}
+
+int sysres_perf_read(struct sysres_perf_counters *counters)
+{
+	long long start = sysres_stats_begin("sysres_perf_read");
+
+	memset(counters, 0, sizeof(*counters));
+	counters->cycles = counters->instructions = -1;
+	counters->cache_references = counters->cache_misses = -1;
+	counters->branch_misses = -1;
+	counters->task_clock_ns = counters->page_faults = counters->context_switches = -1;
+
+	read_group(&software, counters);
+	if (software.exclude_kernel)
+	{
+		counters->context_switches = -1;
+	}
+	/* Read last so the hardware times win: only they show multiplexing */
+	read_group(&hardware, counters);
+	counters->timestamp_ns = sysres_now_ns();
+	counters->mode = hardware.count > 0 ? SYSRES_PERF_HARDWARE : software.count > 0 ? SYSRES_PERF_SOFTWARE : SYSRES_PERF_NONE;
+
+	sysres_stats_end("sysres_perf_read", start);
+	if (counters->mode == SYSRES_PERF_NONE)
+	{
+		memset(counters, 0, sizeof(*counters));
+		return -1;
+	}
+	return 0;
+}
+
+#else
+
+int sysres_perf_open()
+{
+	return SYSRES_PERF_NONE;
+}
+
+int sysres_perf_read(struct sysres_perf_counters *counters)
+{
+	memset(counters, 0, sizeof(*counters));
+	return -1;
+}
+
+void sysres_perf_close()
+{
+}
+
+#endif
+
+/* Delta of one counter, or -1 if missing on either side */
+static long long perf_delta(long long before, long long after)
+{
+	return before < 0 || after < 0 ? -1 : after - before;
+}
+
+void sysres_perf_window(const struct sysres_perf_counters *before, const struct sysres_perf_counters *after, struct sysres_perf_window *window)
+{
+	memset(window, 0, sizeof(*window));
+	long long elapsed = after->timestamp_ns - before->timestamp_ns;
+	if (elapsed <= 0)
+	{
+		return;
+	}
+	window->seconds = (double)elapsed / 1e9;
+
+	long long cycles = perf_delta(before->cycles, after->cycles);
+	long long instructions = perf_delta(before->instructions, after->instructions);
+	if (cycles > 0 && instructions >= 0)
+	{
+		window->ipc = (double)instructions / (double)cycles;
+	}
+
+	long long references = perf_delta(before->cache_references, after->cache_references);
+	long long misses = perf_delta(before->cache_misses, after->cache_misses);
+	if (references > 0 && misses >= 0)
+	{
+		window->cache_miss_ratio = (double)misses / (double)references;
+	}
+
+	long long branch_misses = perf_delta(before->branch_misses, after->branch_misses);
+	long long task_clock = perf_delta(before->task_clock_ns, after->task_clock_ns);
+	long long page_faults = perf_delta(before->page_faults, after->page_faults);
+	long long switches = perf_delta(before->context_switches, after->context_switches);
+	window->branch_miss_rate = branch_misses > 0 ? (double)branch_misses / window->seconds : 0.0;
+	window->cpus = task_clock > 0 ? (double)task_clock / (double)elapsed : 0.0;
+	window->page_fault_rate = page_faults > 0 ? (double)page_faults / window->seconds : 0.0;
+	window->context_switch_rate = switches > 0 ? (double)switches / window->seconds : 0.0;
+}
@@ -0,0 +1,84 @@
+#include "sysres.h"
+#include "sysres_internal.h"
+
+// Linux
+#if __unix__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+
+/*
+ * Root prefix for every /sys and /proc path.
+ *
+ * Pointing it at a fixture tree (see test/fixtures/) lets every backend
+ * be tested and benchmarked against controlled inputs on any Linux
+ * machine. Empty by default, in which case paths are used unchanged.
+ */
+
+static pthread_once_t root_once = PTHREAD_ONCE_INIT;
+static char root[PATH_MAX] = {0};
+
+static void set_root_value(const char *path)
+{
+	if (path == NULL || path[0] == '\0' || strcmp(path, "/") == 0)
+	{
+		root[0] = '\0';
+		return;
+	}
+
+	snprintf(root, sizeof(root), "%s", path);
+
+	/* Strip a trailing slash so "<root>" + "/proc/..." stays clean */
+	size_t len = strlen(root);
+	if (len > 1 && root[len - 1] == '/')
+	{
+		root[len - 1] = '\0';
+	}
+}
+
+static void init_root()
+{
+	set_root_value(getenv("SYSRES_ROOT"));
+}
+
+void sysres_set_root(const char *path)
+{
+	/* Make sure a later first use does not overwrite this with the env */
+	pthread_once(&root_once, init_root);
+	set_root_value(path);
+
+	sysres_invalidate_limits();
+	sysres_reset_memory_backend();
+}
+
+int sysres_is_rooted()
+{
+	pthread_once(&root_once, init_root);
+	return root[0] != '\0';
+}
+
+const char *sysres_path(char *buf, size_t size, const char *path)
+{
+	if (!sysres_is_rooted())
+	{
+		return path;
+	}
+
+	snprintf(buf, size, "%s%s", root, path);
+	return buf;
+}
+
+#endif
+
+#if __MACH__
+
+/* macOS reads metrics through sysctl and Mach calls, not files */
+void sysres_set_root(const char *path)
+{
+	(void)path;
+}
+
+#endif
@@ -0,0 +1,192 @@
+#include "sysres.h"
+#include "sysres_internal.h"
+#include "sysres_probes.h"
+
+#include <limits.h>
+#include <stdatomic.h>
+#include <time.h>
+
+/*
+ * Self-instrumentation counters.
+ *
+ * Plain relaxed atomics: each counter is exact, but a sysres_get_stats()
+ * racing with readers may see one call's counters partially applied.
+ * That is fine for overhead metrics and keeps the hot path lock-free.
+ */
+
+static const char *source_names[SYSRES_SOURCE_COUNT] = {
+	"loadavg",
+	"cpu.max",
+	"cpu_online",
+	"memory.max",
+	"memory.current",
+	"meminfo",
+	"host_statistics",
+	"sysctl",
+	"node_online",
+	"node_meminfo",
+	"numastat",
+	"memory.numa_stat",
+	"perf_event",
+};
+
+struct source_counters
+{
+	atomic_llong reads;
+	atomic_llong failures;
+	atomic_llong fallbacks;
+	atomic_llong bytes;
+	atomic_llong syscalls;
+};
+
+static atomic_llong calls = 0;
+static atomic_llong total_ns = 0;
+static atomic_llong min_ns = LLONG_MAX;
+static atomic_llong max_ns = 0;
+static atomic_llong io_ns = 0;
+static struct source_counters sources[SYSRES_SOURCE_COUNT];
+
+long long sysres_now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+long long sysres_stats_begin(const char *entry)
+{
+	SYSRES_PROBE1(sample__start, entry);
+	return sysres_now_ns();
+}
+
+void sysres_stats_end(const char *entry, long long start_ns)
+{
+	long long elapsed = sysres_now_ns() - start_ns;
+	SYSRES_PROBE2(sample__end, entry, elapsed);
+	atomic_fetch_add_explicit(&calls, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&total_ns, elapsed, memory_order_relaxed);
+
+	long long seen = atomic_load_explicit(&min_ns, memory_order_relaxed);
+	while (elapsed < seen && !atomic_compare_exchange_weak_explicit(&min_ns, &seen, elapsed, memory_order_relaxed, memory_order_relaxed))
+	{
+	}
+	seen = atomic_load_explicit(&max_ns, memory_order_relaxed);
+	while (elapsed > seen && !atomic_compare_exchange_weak_explicit(&max_ns, &seen, elapsed, memory_order_relaxed, memory_order_relaxed))
+	{
+	}
+}
+
+void sysres_count_read(int source, int failed, long long bytes, long long syscalls, long long elapsed_ns)
+{
+	SYSRES_PROBE5(read, source_names[source], bytes, syscalls, elapsed_ns, failed);
+
+	struct source_counters *counters = &sources[source];
+	atomic_fetch_add_explicit(&counters->reads, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&counters->bytes, bytes, memory_order_relaxed);
+	atomic_fetch_add_explicit(&counters->syscalls, syscalls, memory_order_relaxed);
+	if (failed)
+	{
+		atomic_fetch_add_explicit(&counters->failures, 1, memory_order_relaxed);
+	}
+	atomic_fetch_add_explicit(&io_ns, elapsed_ns, memory_order_relaxed);
+}
+
+void sysres_count_fallback(int source)
+{
+	atomic_fetch_add_explicit(&sources[source].fallbacks, 1, memory_order_relaxed);
+}
+
+void sysres_parse_failed(int source)
+{
+	SYSRES_PROBE1(parse__fail, source_names[source]);
+	atomic_fetch_add_explicit(&sources[source].failures, 1, memory_order_relaxed);
+}
+
+void sysres_limit_changed(const char *limit, long long old_value, long long new_value)
+{
+	SYSRES_PROBE3(limit__change, limit, old_value, new_value);
+}
+
+void sysres_get_stats(struct sysres_stats *stats)
+{
+	stats->calls = atomic_load_explicit(&calls, memory_order_relaxed);
+	stats->total_ns = atomic_load_explicit(&total_ns, memory_order_relaxed);
+	long long min = atomic_load_explicit(&min_ns, memory_order_relaxed);
+	stats->min_ns = min == LLONG_MAX ? 0 : min;
+	stats->max_ns = atomic_load_explicit(&max_ns, memory_order_relaxed);
+	stats->io_ns = atomic_load_explicit(&io_ns, memory_order_relaxed);
+
+	for (int i = 0; i < SYSRES_SOURCE_COUNT; i++)
+	{
+		stats->sources[i].reads = atomic_load_explicit(&sources[i].reads, memory_order_relaxed);
+		stats->sources[i].failures = atomic_load_explicit(&sources[i].failures, memory_order_relaxed);
+		stats->sources[i].fallbacks = atomic_load_explicit(&sources[i].fallbacks, memory_order_relaxed);
+		stats->sources[i].bytes = atomic_load_explicit(&sources[i].bytes, memory_order_relaxed);
+		stats->sources[i].syscalls = atomic_load_explicit(&sources[i].syscalls, memory_order_relaxed);
+	}
+}
+
+void sysres_reset_stats()
+{
+	atomic_store_explicit(&calls, 0, memory_order_relaxed);
+	atomic_store_explicit(&total_ns, 0, memory_order_relaxed);
+	atomic_store_explicit(&min_ns, LLONG_MAX, memory_order_relaxed);
+	atomic_store_explicit(&max_ns, 0, memory_order_relaxed);
+	atomic_store_explicit(&io_ns, 0, memory_order_relaxed);
+
+	for (int i = 0; i < SYSRES_SOURCE_COUNT; i++)
+	{
+		atomic_store_explicit(&sources[i].reads, 0, memory_order_relaxed);
+		atomic_store_explicit(&sources[i].failures, 0, memory_order_relaxed);
+		atomic_store_explicit(&sources[i].fallbacks, 0, memory_order_relaxed);
+		atomic_store_explicit(&sources[i].bytes, 0, memory_order_relaxed);
+		atomic_store_explicit(&sources[i].syscalls, 0, memory_order_relaxed);
+	}
+}
+
+const char *sysres_source_name(int source)
+{
+	if (source < 0 || source >= SYSRES_SOURCE_COUNT)
+	{
+		return NULL;
+	}
+	return source_names[source];
+}
+
+// Linux
+#if __unix__
+
+#include <fcntl.h>
+#include <unistd.h>
+
+size_t sysres_read_file(int source, const char *path, char *buff, size_t size)
+{
+	long long start = sysres_now_ns();
+	long long syscalls = 1;
+	size_t len = 0;
+
+	char rooted[PATH_MAX];
+	int fd = open(sysres_path(rooted, sizeof(rooted), path), O_RDONLY | O_CLOEXEC);
+	if (fd >= 0)
+	{
+		/* Read to EOF: sysfs and procfs may return short reads */
+		while (len < size - 1)
+		{
+			ssize_t n = read(fd, buff + len, size - 1 - len);
+			syscalls++;
+			if (n <= 0)
+			{
+				break;
+			}
+			len += (size_t)n;
+		}
+		close(fd);
+		syscalls++;
+	}
+	buff[len] = '\0';
+
+	sysres_count_read(source, len == 0, (long long)len, syscalls, sysres_now_ns() - start);
+	return len;
+}
+
+#endif
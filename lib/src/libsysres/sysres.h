@@ -14,6 +14,13 @@
 float get_cpu_load();
 float get_cpu_limit_cores();
 
+/*
+ * CPU limit inputs (cpu.max, online CPU count) are cached and re-read at
+ * most once per second. Call this after a CPU hotplug or cgroup limit
+ * change to have them re-read on next use instead.
+ */
+void sysres_invalidate_limits();
+
 /* Memory functions */
 float get_memory_usage();
 long long get_memory_limit_bytes();
@@ -21,3 +28,165 @@ long long get_memory_used_bytes();
 
 /* Container detection */
 int is_container_env();
+
+/*
+ * Memory per NUMA node (Linux). Every field is a long long, so FFI callers
+ * can read it as an array.
+ *
+ * anon_bytes and file_bytes are the cgroup's own pages on the node, from
+ * memory.numa_stat, when cgroup_scoped is 1; otherwise they are the
+ * node-wide AnonPages and FilePages. The numastat counters are node-wide
+ * page counts since boot; callers derive rates from two reads.
+ */
+struct sysres_numa_node
+{
+	long long node;
+	long long cgroup_scoped;
+	long long anon_bytes;
+	long long file_bytes;
+	long long total_bytes;  /* node MemTotal */
+	long long free_bytes;   /* node MemFree */
+	long long numa_hit;     /* allocations satisfied on the intended node */
+	long long numa_miss;    /* allocations placed here because the intended node was full */
+	long long numa_foreign; /* allocations intended here but placed elsewhere */
+	long long local_node;   /* allocations by a CPU of this node, placed here */
+	long long other_node;   /* allocations by a CPU of another node, placed here */
+};
+
+/*
+ * Fills up to max_nodes entries for the online NUMA nodes. Returns the
+ * number filled: 0 on macOS or when sysfs exposes no nodes.
+ */
+int get_numa_nodes(struct sysres_numa_node *nodes, int max_nodes);
+
+/*
+ * Hardware performance counters (Linux, optional).
+ *
+ * sysres_perf_open() starts process-wide counters through
+ * perf_event_open(2): a hardware group (cycles, instructions, cache
+ * references and misses, branch misses) when the PMU is accessible, and a
+ * software group (task-clock, page faults, context switches) that works
+ * in most containers and VMs where the PMU is hidden or
+ * perf_event_paranoid forbids it. Each group is read with a single
+ * read(2) (PERF_FORMAT_GROUP), so its counters cover the same interval.
+ *
+ * Counters use inherit, so they cover the calling thread and every thread
+ * and child process it creates afterwards: open them early, before
+ * starting worker threads. Only user-space events are counted where the
+ * kernel restricts kernel profiling; context switches, which only the
+ * kernel sees, then read as -1.
+ *
+ * Open and close are not safe to call while other threads are reading.
+ * Built without support (make PERF=0) or on macOS, open returns
+ * SYSRES_PERF_NONE.
+ */
+enum sysres_perf_mode
+{
+	SYSRES_PERF_NONE,     /* nothing could be opened */
+	SYSRES_PERF_SOFTWARE, /* software group only */
+	SYSRES_PERF_HARDWARE, /* hardware group, and software if allowed */
+};
+
+/*
+ * Cumulative counts since sysres_perf_open(). Every field is a long long,
+ * so FFI callers can read it as an array. Counters that could not be
+ * opened are -1. Values are scaled up when the kernel multiplexed the
+ * group (time_running < time_enabled).
+ */
+struct sysres_perf_counters
+{
+	long long mode;             /* enum sysres_perf_mode */
+	long long timestamp_ns;     /* CLOCK_MONOTONIC at the read */
+	long long time_enabled_ns;  /* summed over the counted threads */
+	long long time_running_ns;  /* part of it the group was on the PMU */
+	long long cycles;
+	long long instructions;
+	long long cache_references;
+	long long cache_misses;
+	long long branch_misses;
+	long long task_clock_ns;    /* CPU time of the counted threads */
+	long long page_faults;
+	long long context_switches;
+};
+
+/* Rates over the interval between two reads; 0 where a counter is missing */
+struct sysres_perf_window
+{
+	double seconds;             /* wall time between the reads */
+	double ipc;                 /* instructions per cycle */
+	double cache_miss_ratio;    /* cache misses per cache reference */
+	double branch_miss_rate;    /* branch misses per second */
+	double cpus;                /* task-clock per second: CPUs kept busy */
+	double page_fault_rate;     /* page faults per second */
+	double context_switch_rate; /* context switches per second */
+};
+
+/* Opens the counters (again, if already open). Returns the mode. */
+int sysres_perf_open();
+
+/* Fills counters. Returns 0, or -1 if nothing is open (counters zeroed). */
+int sysres_perf_read(struct sysres_perf_counters *counters);
+
+/* Derives per-window rates from two reads, before and after. */
+void sysres_perf_window(const struct sysres_perf_counters *before, const struct sysres_perf_counters *after, struct sysres_perf_window *window);
+
+void sysres_perf_close();
+
+/*
+ * Prefixes every /sys and /proc path with root (e.g. a fixture tree), or
+ * restores the real filesystem when root is NULL or "". Defaults to the
+ * SYSRES_ROOT environment variable. Not safe to call while other threads
+ * are reading metrics.
+ */
+void sysres_set_root(const char *root);
+
+/*
+ * Self-instrumentation: what monitoring itself costs.
+ *
+ * Every public getter call is timed, and every source it reads (files on
+ * Linux, sysctl and Mach calls on macOS) is counted. Counters are
+ * cumulative since the library was loaded or sysres_reset_stats().
+ */
+enum sysres_source
+{
+	SYSRES_SOURCE_LOADAVG,
+	SYSRES_SOURCE_CPU_MAX,
+	SYSRES_SOURCE_CPU_ONLINE,
+	SYSRES_SOURCE_MEMORY_MAX,
+	SYSRES_SOURCE_MEMORY_CURRENT,
+	SYSRES_SOURCE_MEMINFO,
+	SYSRES_SOURCE_HOST_STATISTICS,
+	SYSRES_SOURCE_SYSCTL,
+	SYSRES_SOURCE_NODE_ONLINE,
+	SYSRES_SOURCE_NODE_MEMINFO,
+	SYSRES_SOURCE_NUMASTAT,
+	SYSRES_SOURCE_MEMORY_NUMA_STAT,
+	SYSRES_SOURCE_PERF_EVENT,
+	SYSRES_SOURCE_COUNT
+};
+
+struct sysres_source_stats
+{
+	long long reads;     /* reads of this source */
+	long long failures;  /* reads that returned nothing or could not be parsed */
+	long long fallbacks; /* reads made because a preferred source was unusable */
+	long long bytes;     /* bytes read (files only) */
+	long long syscalls;  /* system calls issued by the reads */
+};
+
+/* Every field is a long long, so FFI callers can read it as an array */
+struct sysres_stats
+{
+	long long calls;    /* public getter calls */
+	long long total_ns; /* time spent in them */
+	long long min_ns;   /* fastest call, 0 before the first one */
+	long long max_ns;   /* slowest call */
+	long long io_ns;    /* part of total_ns spent reading sources; the rest is parsing */
+	struct sysres_source_stats sources[SYSRES_SOURCE_COUNT];
+};
+
+void sysres_get_stats(struct sysres_stats *stats);
+void sysres_reset_stats();
+
+/* Short name of a source (e.g. "memory.current"), or NULL if out of range */
+const char *sysres_source_name(int source);
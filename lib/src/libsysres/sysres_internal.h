@@ -0,0 +1,53 @@
+/*
+ * Helpers shared between the libsysres translation units.
+ * Not part of the public API (see sysres.h).
+ */
+
+#include <stddef.h>
+
+/*
+ * Returns path prefixed with the root set by sysres_set_root() or the
+ * SYSRES_ROOT environment variable. Without a root, returns path itself
+ * and buf is left untouched.
+ */
+const char *sysres_path(char *buf, size_t size, const char *path);
+
+/* Returns non-zero when a root prefix is in effect. */
+int sysres_is_rooted();
+
+/* Forces the memory backend to be selected again on next use. */
+void sysres_reset_memory_backend();
+
+/* Self-instrumentation (see sysres_get_stats in sysres.h) */
+
+/*
+ * Call at the start of a public getter with its name; pass the same name
+ * and the result to stats_end. Also fire the sample probes.
+ */
+long long sysres_stats_begin(const char *entry);
+void sysres_stats_end(const char *entry, long long start_ns);
+
+/*
+ * Reads the file at path (under the root) into buff, NUL-terminated, with
+ * plain open/read/close so the syscalls are exact. Returns the number of
+ * bytes read, 0 if the file is missing or empty. Counted against source.
+ */
+size_t sysres_read_file(int source, const char *path, char *buff, size_t size);
+
+/* Counts a non-file read (e.g. getloadavg, Mach calls) against source. */
+void sysres_count_read(int source, int failed, long long bytes, long long syscalls, long long elapsed_ns);
+
+/*
+ * Reports that the contents read from source could not be parsed. Counted
+ * as a failure of that read, so call it only after a read that succeeded.
+ */
+void sysres_parse_failed(int source);
+
+/* Reports a limit that differs from the last value seen (see sysres_probes.h). */
+void sysres_limit_changed(const char *limit, long long old_value, long long new_value);
+
+/* Counts the next read of source as a fallback from a preferred source. */
+void sysres_count_fallback(int source);
+
+/* CLOCK_MONOTONIC in nanoseconds */
+long long sysres_now_ns();
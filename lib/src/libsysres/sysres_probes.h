@@ -0,0 +1,47 @@
+/*
+ * USDT (user statically-defined tracing) probes, provider "sysres".
+ *
+ * Compiled in on Linux when <sys/sdt.h> is available (systemtap-sdt-dev
+ * or equivalent) unless SYSRES_NO_USDT is defined (make USDT=0). Each
+ * probe is a single nop plus an ELF note until a tracer attaches, so
+ * arguments are restricted to values already at hand.
+ *
+ * Probes and arguments:
+ *   sample__start(const char *entry)
+ *       a public entry point (e.g. "get_cpu_load") starts
+ *   sample__end(const char *entry, long long elapsed_ns)
+ *       it returns
+ *   read(const char *source, long long bytes, long long syscalls,
+ *        long long elapsed_ns, int failed)
+ *       one source read (file, getloadavg, sysctl, Mach call)
+ *   parse__fail(const char *source)
+ *       a source was read but its contents could not be parsed
+ *   limit__change(const char *limit, long long old, long long new)
+ *       a limit differs from the last value seen: "cpu.max" in
+ *       millicores, "cpu_online" in CPUs, "memory.max" in bytes
+ *       (-1 means unlimited)
+ *
+ * Example, read latency per source on a live process:
+ *   bpftrace -e 'usdt:/path/libsysres-linux-x86_64.so:sysres:read
+ *     { @[str(arg0)] = hist(arg3); }' -p PID
+ */
+
+#if !defined(SYSRES_NO_USDT) && defined(__linux__) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define SYSRES_USDT 1
+#endif
+#endif
+
+#if SYSRES_USDT
+#define SYSRES_PROBE1(name, a) DTRACE_PROBE1(sysres, name, a)
+#define SYSRES_PROBE2(name, a, b) DTRACE_PROBE2(sysres, name, a, b)
+#define SYSRES_PROBE3(name, a, b, c) DTRACE_PROBE3(sysres, name, a, b, c)
+#define SYSRES_PROBE5(name, a, b, c, d, e) DTRACE_PROBE5(sysres, name, a, b, c, d, e)
+#else
+/* Arguments are still "used" so disabled builds have no unused warnings */
+#define SYSRES_PROBE1(name, a) ((void)(a))
+#define SYSRES_PROBE2(name, a, b) ((void)(a), (void)(b))
+#define SYSRES_PROBE3(name, a, b, c) ((void)(a), (void)(b), (void)(c))
+#define SYSRES_PROBE5(name, a, b, c, d, e) ((void)(a), (void)(b), (void)(c), (void)(d), (void)(e))
+#endif
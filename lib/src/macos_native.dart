@@ -1,6 +1,10 @@
 import 'dart:ffi';
 import 'dart:io';
 
+import 'package:ffi/ffi.dart';
+
+import 'self_stats.dart';
+
 /// FFI bindings for macOS native library.
 ///
 /// This provides system resource monitoring on macOS using the native
@@ -22,6 +26,16 @@ typedef GetMemoryLimitBytes = int Function();
 typedef GetMemoryUsedBytesNative = Int64 Function();
 typedef GetMemoryUsedBytes = int Function();
 
+/// `struct sysres_stats` is read as an array of int64 (see sysres.h).
+typedef SysresGetStatsNative = Void Function(Pointer<Int64>);
+typedef SysresGetStats = void Function(Pointer<Int64>);
+
+typedef SysresResetStatsNative = Void Function();
+typedef SysresResetStats = void Function();
+
+typedef SysresSourceNameNative = Pointer<Utf8> Function(Int32);
+typedef SysresSourceName = Pointer<Utf8> Function(int);
+
 /// macOS native library wrapper for system resources.
 class MacOsNative {
   static DynamicLibrary? _lib;
@@ -30,6 +44,15 @@ class MacOsNative {
   static GetMemoryUsage? _getMemoryUsage;
   static GetMemoryLimitBytes? _getMemoryLimitBytes;
   static GetMemoryUsedBytes? _getMemoryUsedBytes;
+  static SysresGetStats? _getStats;
+  static SysresResetStats? _resetStats;
+  static List<String> _sourceNames = const [];
+  static Pointer<Int64>? _statsBuffer;
+
+  /// Fields of `struct sysres_stats` before the per-source array, and
+  /// fields per `struct sysres_source_stats`.
+  static const _statsHeader = 5;
+  static const _sourceFields = 5;
 
   static bool _initialized = false;
 
@@ -58,9 +81,68 @@ class MacOsNative {
     _getMemoryUsedBytes = _lib!.lookupFunction<GetMemoryUsedBytesNative,
         GetMemoryUsedBytes>('get_memory_used_bytes');
 
+    // Libraries built before self-instrumentation do not export stats.
+    if (_lib!.providesSymbol('sysres_get_stats')) {
+      _getStats = _lib!.lookupFunction<SysresGetStatsNative, SysresGetStats>(
+          'sysres_get_stats');
+      _resetStats = _lib!
+          .lookupFunction<SysresResetStatsNative, SysresResetStats>(
+              'sysres_reset_stats');
+      final sourceName = _lib!
+          .lookupFunction<SysresSourceNameNative, SysresSourceName>(
+              'sysres_source_name');
+      _sourceNames = [
+        for (var i = 0; sourceName(i) != nullptr; i++)
+          sourceName(i).toDartString(),
+      ];
+    }
+
     _initialized = true;
   }
 
+  /// The native library's self-instrumentation counters, or `null` if the
+  /// library is not loaded or predates them. Only sources that were read
+  /// are included.
+  static ({
+    int reads,
+    int syscalls,
+    int ioMicros,
+    Map<String, SourceStats> sources,
+  })? readStats() {
+    final getStats = _getStats;
+    if (!_initialized || getStats == null) return null;
+
+    final buffer = _statsBuffer ??= calloc<Int64>(
+        _statsHeader + _sourceNames.length * _sourceFields);
+    getStats(buffer);
+
+    var reads = 0;
+    var syscalls = 0;
+    final sources = <String, SourceStats>{};
+    for (var i = 0; i < _sourceNames.length; i++) {
+      final base = _statsHeader + i * _sourceFields;
+      if (buffer[base] == 0) continue;
+      reads += buffer[base];
+      syscalls += buffer[base + 4];
+      sources[_sourceNames[i]] = SourceStats(
+        reads: buffer[base],
+        failures: buffer[base + 1],
+        fallbacks: buffer[base + 2],
+        bytes: buffer[base + 3],
+        syscalls: buffer[base + 4],
+      );
+    }
+    return (
+      reads: reads,
+      syscalls: syscalls,
+      ioMicros: buffer[4] ~/ 1000,
+      sources: sources,
+    );
+  }
+
+  /// Resets the native counters, if available.
+  static void resetStats() => _resetStats?.call();
+
   /// Get the library filename for macOS.
   static String _getLibraryPath() {
     final arch = _getArch();
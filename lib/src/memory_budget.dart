@@ -0,0 +1,92 @@
+import 'dart:async';
+
+import 'resource_sampler.dart';
+
+/// Continuously updated byte budget for sizing in-process caches.
+///
+/// The budget is `fraction * (effectiveLimit - nonCacheWorkingSet)`, where
+/// the effective limit is the lower of `memory.high` and `memory.max` and
+/// the non-cache working set is the sampled working set minus the bytes
+/// the caches report through [reportUsage]. Caches therefore shrink when
+/// the rest of the process grows and grow back when headroom returns.
+///
+/// A new budget is only published when it differs from the current one by
+/// more than [hysteresis] (relative), so caches are not resized on every
+/// small fluctuation.
+///
+/// ```dart
+/// final budget = SystemResources.memoryBudget(0.3);
+/// budget.changes.listen((bytes) => cache.resize(bytes));
+///
+/// // After each cache mutation:
+/// budget.reportUsage(cache.sizeInBytes);
+/// ```
+class MemoryBudget {
+  final double fraction;
+  final double hysteresis;
+
+  int _bytes = 0;
+  int _cacheBytes = 0;
+  bool _hasValue = false;
+  final StreamController<int> _changes = StreamController<int>.broadcast();
+  StreamSubscription<ResourceSnapshot>? _subscription;
+
+  MemoryBudget(this.fraction, {this.hysteresis = 0.05}) {
+    if (fraction <= 0 || fraction > 1) {
+      throw ArgumentError.value(fraction, 'fraction', 'Must be in (0, 1]');
+    }
+    if (hysteresis < 0 || hysteresis >= 1) {
+      throw ArgumentError.value(hysteresis, 'hysteresis', 'Must be in [0, 1)');
+    }
+  }
+
+  /// Current budget in bytes.
+  int get bytes => _bytes;
+
+  /// Emits the new budget every time it is republished.
+  Stream<int> get changes => _changes.stream;
+
+  /// Reports how many bytes the caches using this budget currently hold,
+  /// so they are not counted as non-cache working set.
+  void reportUsage(int cacheBytes) {
+    _cacheBytes = cacheBytes < 0 ? 0 : cacheBytes;
+  }
+
+  /// Computes the unfiltered budget for [snapshot].
+  int compute(ResourceSnapshot snapshot) {
+    final limit = snapshot.effectiveMemoryLimitBytes > 0
+        ? snapshot.effectiveMemoryLimitBytes
+        : snapshot.memoryLimitBytes;
+    if (limit <= 0) return 0;
+
+    final nonCache = snapshot.workingSetBytes - _cacheBytes;
+    final available = limit - (nonCache > 0 ? nonCache : 0);
+    return available > 0 ? (available * fraction).floor() : 0;
+  }
+
+  /// Recomputes the budget from [snapshot], publishing it if it moved by
+  /// more than [hysteresis]. Called on every sampler tick when attached.
+  void update(ResourceSnapshot snapshot) {
+    final next = compute(snapshot);
+    if (_hasValue) {
+      final band = _bytes * hysteresis;
+      if ((next - _bytes).abs() <= band) return;
+    }
+    _hasValue = true;
+    _bytes = next;
+    if (_changes.hasListener) _changes.add(next);
+  }
+
+  /// Updates the budget on every snapshot of [snapshots] until [close].
+  void attach(Stream<ResourceSnapshot> snapshots) {
+    _subscription?.cancel();
+    _subscription = snapshots.listen(update);
+  }
+
+  /// Stops following sampler snapshots and closes [changes].
+  Future<void> close() async {
+    await _subscription?.cancel();
+    _subscription = null;
+    await _changes.close();
+  }
+}
@@ -0,0 +1,204 @@
+import 'platform_detector.dart';
+import 'self_stats.dart';
+
+/// Page fault and reclaim activity, as events per second since the
+/// previous [MemoryEventMonitor.read] (or, for the sampler, the previous
+/// [MemoryEventMonitor.sample]). Rates are 0 on the first read.
+///
+/// High fault and activation rates with efficient reclaim are allocation
+/// churn (e.g. a GC cycling through young pages); usage that keeps growing
+/// while reclaim scans a lot and steals little is a leak, or a working set
+/// that no longer fits.
+class MemoryEventRates {
+  /// Whether the counters are the whole host's (`/proc/vmstat`, used
+  /// without cgroup v2) rather than the cgroup's (`memory.stat`).
+  final bool hostWide;
+
+  /// Page faults (`pgfault`), minor and major, and major faults alone
+  /// (`pgmajfault`), which had to wait for I/O.
+  final double faultsPerSecond;
+  final double majorFaultsPerSecond;
+
+  /// Pages promoted to (`pgactivate`) and demoted from (`pgdeactivate`)
+  /// the active LRU lists.
+  final double activationsPerSecond;
+  final double deactivationsPerSecond;
+
+  /// Active pages scanned for deactivation (`pgrefill`).
+  final double refillsPerSecond;
+
+  /// Inactive pages scanned (`pgscan`) and reclaimed (`pgsteal`) by
+  /// kswapd and direct reclaim.
+  final double scansPerSecond;
+  final double stealsPerSecond;
+
+  /// Pages reclaimed per page scanned over the interval. Values well
+  /// below 1.0 mean reclaim works hard for little memory; 1.0 when
+  /// nothing was scanned.
+  final double reclaimEfficiency;
+
+  const MemoryEventRates({
+    this.hostWide = false,
+    this.faultsPerSecond = 0.0,
+    this.majorFaultsPerSecond = 0.0,
+    this.activationsPerSecond = 0.0,
+    this.deactivationsPerSecond = 0.0,
+    this.refillsPerSecond = 0.0,
+    this.scansPerSecond = 0.0,
+    this.stealsPerSecond = 0.0,
+    this.reclaimEfficiency = 1.0,
+  });
+
+  static const empty = MemoryEventRates();
+}
+
+/// Derives [MemoryEventRates] from the event counters of cgroup v2
+/// `memory.stat`, or of `/proc/vmstat` on cgroup v1 and hosts (cgroup v1
+/// `memory.stat` has no reclaim counters).
+///
+/// `/proc/vmstat` splits scans and steals by reclaimer
+/// (`pgscan_kswapd`, `pgscan_direct`, `pgscan_khugepaged`); those are
+/// summed. `memory.stat` has the same split next to the `pgscan` and
+/// `pgsteal` totals, which are preferred.
+class MemoryEventMonitor {
+  static final Stopwatch _clock = Stopwatch()..start();
+
+  /// Counters of the previous [read] and of the previous [sample].
+  static final _readState = _MemoryEventCounters();
+  static final _sampleState = _MemoryEventCounters();
+  static final List<int> _current = List.filled(_counterCount, 0);
+
+  static const _faults = 0;
+  static const _majorFaults = 1;
+  static const _activations = 2;
+  static const _deactivations = 3;
+  static const _refills = 4;
+  static const _scans = 5;
+  static const _steals = 6;
+  static const _counterCount = 7;
+
+  /// Rates since the previous [read].
+  static MemoryEventRates read() => _readWith(_readState);
+
+  /// Rates since the previous [sample], for the sampler. Kept apart from
+  /// [read] so callers and the sampler do not shorten each other's
+  /// intervals.
+  static MemoryEventRates sample() => _readWith(_sampleState);
+
+  static MemoryEventRates _readWith(_MemoryEventCounters state) {
+    final platform = PlatformDetector.detectPlatform();
+    if (platform == DetectedPlatform.macOS ||
+        platform == DetectedPlatform.unsupported) {
+      return MemoryEventRates.empty;
+    }
+    final hostWide = platform != DetectedPlatform.linuxCgroupV2;
+    final path = hostWide
+        ? PlatformDetector.procVmstat
+        : PlatformDetector.cgroupV2MemoryStat;
+    if (!_parse(path)) return MemoryEventRates.empty;
+
+    final now = _clock.elapsedMicroseconds;
+    final previousMicros =
+        path == state.previousPath ? state.previousMicros : null;
+    final elapsed = previousMicros == null ? 0 : now - previousMicros;
+
+    double delta(int counter) {
+      final value = _current[counter] - state.counters[counter];
+      return elapsed > 0 && value > 0 ? value.toDouble() : 0.0;
+    }
+
+    double rate(int counter) =>
+        elapsed > 0 ? delta(counter) * 1e6 / elapsed : 0.0;
+
+    final scanned = delta(_scans);
+    final stolen = delta(_steals);
+    final rates = MemoryEventRates(
+      hostWide: hostWide,
+      faultsPerSecond: rate(_faults),
+      majorFaultsPerSecond: rate(_majorFaults),
+      activationsPerSecond: rate(_activations),
+      deactivationsPerSecond: rate(_deactivations),
+      refillsPerSecond: rate(_refills),
+      scansPerSecond: rate(_scans),
+      stealsPerSecond: rate(_steals),
+      reclaimEfficiency:
+          scanned > 0 ? (stolen < scanned ? stolen / scanned : 1.0) : 1.0,
+    );
+    state.previousPath = path;
+    state.previousMicros = now;
+    state.counters.setAll(0, _current);
+    return rates;
+  }
+
+  /// Reads the counters of [path] into [_current]; false if unreadable.
+  static bool _parse(String path) {
+    final String text;
+    try {
+      text = SelfStats.readFile(path);
+    } catch (_) {
+      return false;
+    }
+    _current.fillRange(0, _counterCount, 0);
+    var scanParts = 0;
+    var stealParts = 0;
+    var hasScanTotal = false;
+    var hasStealTotal = false;
+    for (final line in text.split('\n')) {
+      final space = line.indexOf(' ');
+      if (space < 0) continue;
+      final key = line.substring(0, space);
+      final int counter;
+      switch (key) {
+        case 'pgfault':
+          counter = _faults;
+        case 'pgmajfault':
+          counter = _majorFaults;
+        case 'pgactivate':
+          counter = _activations;
+        case 'pgdeactivate':
+          counter = _deactivations;
+        case 'pgrefill':
+          counter = _refills;
+        case 'pgscan':
+          hasScanTotal = true;
+          counter = _scans;
+        case 'pgsteal':
+          hasStealTotal = true;
+          counter = _steals;
+        case 'pgscan_kswapd' || 'pgscan_direct' || 'pgscan_khugepaged':
+          scanParts += SelfStats.parseInt(line.substring(space + 1), path) ?? 0;
+          continue;
+        case 'pgsteal_kswapd' || 'pgsteal_direct' || 'pgsteal_khugepaged':
+          stealParts +=
+              SelfStats.parseInt(line.substring(space + 1), path) ?? 0;
+          continue;
+        default:
+          continue;
+      }
+      _current[counter] =
+          SelfStats.parseInt(line.substring(space + 1), path) ?? 0;
+    }
+    if (!hasScanTotal) _current[_scans] = scanParts;
+    if (!hasStealTotal) _current[_steals] = stealParts;
+    return true;
+  }
+
+  /// Resets rate state. Useful for testing.
+  static void clearState() {
+    _readState.clear();
+    _sampleState.clear();
+  }
+}
+
+/// Counters from the previous read, for one reader.
+class _MemoryEventCounters {
+  String? previousPath;
+  int? previousMicros;
+  final List<int> counters = List.filled(MemoryEventMonitor._counterCount, 0);
+
+  void clear() {
+    previousPath = null;
+    previousMicros = null;
+    counters.fillRange(0, counters.length, 0);
+  }
+}
@@ -1,60 +1,150 @@
-import 'dart:io';
-
 import 'platform_detector.dart';
+import 'self_stats.dart';
 
 /// Memory monitoring via cgroup files, with `/proc/meminfo` fallback.
 class MemoryMonitor {
   /// Falls back to `/proc/meminfo` when cgroup file is "max" or unreadable.
   static int readV2LimitBytes() {
+    final path = PlatformDetector.cgroupV2MemoryMax;
     try {
-      final content =
-          File(PlatformDetector.cgroupV2MemoryMax).readAsStringSync().trim();
-      if (content == 'max') return readProcMemTotal();
-      return int.tryParse(content) ?? 0;
+      final content = SelfStats.readFile(path).trim();
+      if (content != 'max') return SelfStats.parseInt(content, path) ?? 0;
     } catch (_) {}
-    return readProcMemTotal();
+    return _fallbackProcMemTotal();
   }
 
   /// Values > 9e18 mean unlimited in cgroup v1.
   static int readV1LimitBytes() {
+    final path = PlatformDetector.cgroupV1MemoryLimit;
     try {
-      final content =
-          File(PlatformDetector.cgroupV1MemoryLimit).readAsStringSync().trim();
-      final limit = int.tryParse(content);
-      if (limit != null) {
-        if (limit > 9000000000000000000) return readProcMemTotal();
-        return limit;
-      }
+      final limit = SelfStats.parseInt(SelfStats.readFile(path).trim(), path);
+      if (limit != null && limit <= 9000000000000000000) return limit;
     } catch (_) {}
-    return readProcMemTotal();
+    return _fallbackProcMemTotal();
   }
 
   static int readV2UsedBytes() {
+    final path = PlatformDetector.cgroupV2MemoryCurrent;
     try {
-      final content =
-          File(PlatformDetector.cgroupV2MemoryCurrent).readAsStringSync().trim();
-      return int.tryParse(content) ?? 0;
+      return SelfStats.parseInt(SelfStats.readFile(path).trim(), path) ?? 0;
     } catch (_) {}
-    return readProcMemUsed();
+    return _fallbackProcMemUsed();
   }
 
   static int readV1UsedBytes() {
+    final path = PlatformDetector.cgroupV1MemoryUsage;
+    try {
+      return SelfStats.parseInt(SelfStats.readFile(path).trim(), path) ?? 0;
+    } catch (_) {}
+    return _fallbackProcMemUsed();
+  }
+
+  /// Effective cgroup v2 limit: the lower of `memory.high` (where reclaim
+  /// and throttling start) and [limitBytes] (from [readV2LimitBytes]).
+  static int readV2EffectiveLimitBytes(int limitBytes) {
+    final path = PlatformDetector.cgroupV2MemoryHigh;
     try {
-      final content =
-          File(PlatformDetector.cgroupV1MemoryUsage).readAsStringSync().trim();
-      return int.tryParse(content) ?? 0;
+      final content = SelfStats.readFile(path).trim();
+      final high = content == 'max' ? null : SelfStats.parseInt(content, path);
+      if (high != null && high > 0 && (limitBytes <= 0 || high < limitBytes)) {
+        return high;
+      }
     } catch (_) {}
+    return limitBytes;
+  }
+
+  /// Working set as reported by the kubelet: usage minus inactive file
+  /// cache, which the kernel can reclaim without pressure.
+  static int readV2WorkingSetBytes() {
+    final used = readV2UsedBytes();
+    final inactive =
+        readStatValue(PlatformDetector.cgroupV2MemoryStat, 'inactive_file');
+    return used > inactive ? used - inactive : 0;
+  }
+
+  static int readV1WorkingSetBytes() {
+    final used = readV1UsedBytes();
+    final inactive = readStatValue(
+        PlatformDetector.cgroupV1MemoryStat, 'total_inactive_file');
+    return used > inactive ? used - inactive : 0;
+  }
+
+  /// Reads a single `key value` entry from a flat-keyed cgroup file such
+  /// as `memory.stat`. Returns 0 if the file or key is missing.
+  static int readStatValue(String path, String key) {
+    try {
+      final content = SelfStats.readFile(path);
+      final prefix = '$key ';
+      for (final line in content.split('\n')) {
+        if (line.startsWith(prefix)) {
+          final value = line.substring(prefix.length).trim();
+          return SelfStats.parseInt(value, path) ?? 0;
+        }
+      }
+    } catch (_) {}
+    return 0;
+  }
+
+  /// Reads the downward API `memory_limit` file (bytes). Returns 0 if the
+  /// file is missing or not a positive number.
+  static int readDownwardLimitBytes() {
+    final path = '${PlatformDetector.downwardApiDir}/memory_limit';
+    try {
+      final limit = SelfStats.parseInt(SelfStats.readFile(path).trim(), path);
+      if (limit != null && limit > 0) return limit;
+    } catch (_) {}
+    return 0;
+  }
+
+  /// Reads MemTotal and used memory (MemTotal - MemAvailable) in bytes
+  /// from a single `/proc/meminfo` read. Returns zeros if unavailable.
+  static ({int total, int used}) readProcMemInfo() {
+    final path = PlatformDetector.procMeminfo;
+    try {
+      final content = SelfStats.readFile(path);
+      int? memTotal;
+      int? memAvailable;
+
+      for (final line in content.split('\n')) {
+        if (line.startsWith('MemTotal:')) {
+          memTotal = SelfStats.parseInt(line.split(RegExp(r'\s+'))[1], path);
+        } else if (line.startsWith('MemAvailable:')) {
+          memAvailable =
+              SelfStats.parseInt(line.split(RegExp(r'\s+'))[1], path);
+        }
+        if (memTotal != null && memAvailable != null) {
+          return (
+            total: memTotal * 1024,
+            used: (memTotal - memAvailable) * 1024,
+          );
+        }
+      }
+      if (memTotal != null) return (total: memTotal * 1024, used: 0);
+    } catch (_) {}
+    return (total: 0, used: 0);
+  }
+
+  /// `/proc/meminfo` read because the cgroup source was unlimited or
+  /// unreadable; counted as a fallback in the self-instrumentation.
+  static int _fallbackProcMemTotal() {
+    SelfStats.fallback(PlatformDetector.procMeminfo);
+    return readProcMemTotal();
+  }
+
+  static int _fallbackProcMemUsed() {
+    SelfStats.fallback(PlatformDetector.procMeminfo);
     return readProcMemUsed();
   }
 
   static int readProcMemTotal() {
+    final path = PlatformDetector.procMeminfo;
     try {
-      final content = File(PlatformDetector.procMeminfo).readAsStringSync();
+      final content = SelfStats.readFile(path);
       for (final line in content.split('\n')) {
         if (line.startsWith('MemTotal:')) {
           final parts = line.split(RegExp(r'\s+'));
           if (parts.length >= 2) {
-            final kb = int.tryParse(parts[1]);
+            final kb = SelfStats.parseInt(parts[1], path);
             if (kb != null) return kb * 1024;
           }
         }
@@ -64,8 +154,9 @@ class MemoryMonitor {
   }
 
   static int readProcMemUsed() {
+    final path = PlatformDetector.procMeminfo;
     try {
-      final content = File(PlatformDetector.procMeminfo).readAsStringSync();
+      final content = SelfStats.readFile(path);
       int? memTotal;
       int? memAvailable;
 
@@ -73,12 +164,12 @@ class MemoryMonitor {
         if (line.startsWith('MemTotal:')) {
           final parts = line.split(RegExp(r'\s+'));
           if (parts.length >= 2) {
-            memTotal = int.tryParse(parts[1]);
+            memTotal = SelfStats.parseInt(parts[1], path);
           }
         } else if (line.startsWith('MemAvailable:')) {
           final parts = line.split(RegExp(r'\s+'));
           if (parts.length >= 2) {
-            memAvailable = int.tryParse(parts[1]);
+            memAvailable = SelfStats.parseInt(parts[1], path);
           }
         }
       }
@@ -0,0 +1,113 @@
+import 'dart:io';
+
+import 'platform_detector.dart';
+import 'self_stats.dart';
+
+/// Highest cgroup memory usage between two sampler ticks.
+///
+/// Since Linux 6.12, writing `reset` to cgroup v2 `memory.peak` restarts
+/// the peak for the open file that was written, without affecting other
+/// readers. The monitor keeps its own descriptor open and reads and resets
+/// it on every [sample], so the result is the high-water mark of the whole
+/// interval, including allocation spikes that come and go between ticks.
+///
+/// Where the peak cannot be reset (older kernels, cgroup v1, fixture
+/// roots) the lifetime peak (`memory.peak` or `memory.max_usage_in_bytes`)
+/// is read instead: when it grew since the previous tick, the new value
+/// was reached during the interval; otherwise the best known peak is the
+/// sampled usage itself. Where there is no peak file at all, the sampled
+/// usage is used without further reads until the cgroup changes.
+class MemoryPeakMonitor {
+  static RandomAccessFile? _file;
+  static String? _path;
+  static bool? _resettable;
+  static bool _missing = false;
+  static int? _previousLifetimePeak;
+
+  /// Peak usage since the previous call, at least [currentBytes] (the
+  /// usage sampled on this tick).
+  static int sample(int currentBytes) {
+    final String path;
+    switch (PlatformDetector.detectPlatform()) {
+      case DetectedPlatform.linuxCgroupV2:
+        path = PlatformDetector.cgroupV2MemoryPeak;
+      case DetectedPlatform.linuxCgroupV1:
+        path = PlatformDetector.cgroupV1MemoryMaxUsage;
+      default:
+        return currentBytes;
+    }
+    if (path != _path) {
+      // First call, or the root or cgroup changed.
+      clearState();
+      _path = path;
+    }
+    if (_missing) return currentBytes;
+
+    if (_resettable != false &&
+        PlatformDetector.root.isEmpty &&
+        path.endsWith('/memory.peak')) {
+      final peak = _readAndReset(path);
+      if (peak != null) return peak > currentBytes ? peak : currentBytes;
+    }
+    return _lifetimePeak(path, currentBytes);
+  }
+
+  /// Reads the peak of the private descriptor and resets it, or `null`
+  /// if that is not supported. A newly opened descriptor reports the
+  /// lifetime peak, so the first call only resets it and returns 0.
+  static int? _readAndReset(String path) {
+    final start = SelfStats.nowMicros();
+    var file = _file;
+    try {
+      if (file == null) {
+        file = _file = File(path).openSync(mode: FileMode.append);
+        file.writeStringSync('reset\n');
+        SelfStats.count(path, syscalls: 2, startMicros: start);
+        _resettable = true;
+        return 0;
+      }
+      file.setPositionSync(0);
+      final bytes = file.readSync(32);
+      file.writeStringSync('reset\n');
+      SelfStats.count(path,
+          syscalls: 3, startMicros: start, bytes: bytes.length);
+      return SelfStats.parseInt(String.fromCharCodes(bytes).trim(), path);
+    } on FileSystemException {
+      // EINVAL before Linux 6.12, which cannot reset the peak.
+      SelfStats.count(path, syscalls: 1, startMicros: start, failed: true);
+      _close();
+      _resettable = false;
+      return null;
+    }
+  }
+
+  static int _lifetimePeak(String path, int currentBytes) {
+    try {
+      final peak = SelfStats.parseInt(SelfStats.readFile(path).trim(), path);
+      final previous = _previousLifetimePeak;
+      _previousLifetimePeak = peak;
+      if (peak != null && previous != null && peak > previous) return peak;
+    } on FileSystemException {
+      // Not provided by this kernel or controller: stop retrying.
+      _missing = true;
+    } catch (_) {}
+    return currentBytes;
+  }
+
+  static void _close() {
+    try {
+      _file?.closeSync();
+    } catch (_) {}
+    _file = null;
+  }
+
+  /// Closes the descriptor and forgets the previous peak. Useful for
+  /// testing.
+  static void clearState() {
+    _close();
+    _path = null;
+    _resettable = null;
+    _missing = false;
+    _previousLifetimePeak = null;
+  }
+}
@@ -0,0 +1,357 @@
+import 'platform_detector.dart';
+import 'self_stats.dart';
+
+/// Traffic on one network interface, as rates since the previous read.
+class NetworkInterfaceStats {
+  final String name;
+  final double receiveBytesPerSecond;
+  final double transmitBytesPerSecond;
+  final double receivePacketsPerSecond;
+  final double transmitPacketsPerSecond;
+
+  /// Packets dropped per second, receive plus transmit.
+  final double dropsPerSecond;
+
+  const NetworkInterfaceStats({
+    required this.name,
+    this.receiveBytesPerSecond = 0.0,
+    this.transmitBytesPerSecond = 0.0,
+    this.receivePacketsPerSecond = 0.0,
+    this.transmitPacketsPerSecond = 0.0,
+    this.dropsPerSecond = 0.0,
+  });
+}
+
+/// Network throughput and TCP health of the process's network namespace.
+///
+/// Rates cover the interval since the previous [NetworkMonitor.read] (or,
+/// for the sampler, the previous [NetworkMonitor.sample]) and are 0 on the
+/// first read.
+class NetworkStats {
+  /// Interfaces other than loopback, in `/proc/net/dev` order.
+  final List<NetworkInterfaceStats> interfaces;
+
+  /// TCP segments retransmitted per second (`RetransSegs`).
+  final double tcpRetransmitsPerSecond;
+
+  /// TCP segments sent per second (`OutSegs`).
+  final double tcpSegmentsOutPerSecond;
+
+  /// TCP segments received with errors per second (`InErrs`).
+  final double tcpInErrorsPerSecond;
+
+  /// TCP sockets in use and orphaned (`/proc/net/sockstat`).
+  final int tcpSocketsInUse;
+  final int tcpOrphans;
+
+  /// Pages allocated to TCP socket buffers, and the `tcp_mem` thresholds
+  /// at which the kernel starts moderating buffers (pressure) and refuses
+  /// to grow them (limit). The thresholds are 0 if unreadable.
+  final int tcpMemoryPages;
+  final int tcpMemoryPressurePages;
+  final int tcpMemoryLimitPages;
+
+  const NetworkStats({
+    this.interfaces = const [],
+    this.tcpRetransmitsPerSecond = 0.0,
+    this.tcpSegmentsOutPerSecond = 0.0,
+    this.tcpInErrorsPerSecond = 0.0,
+    this.tcpSocketsInUse = 0,
+    this.tcpOrphans = 0,
+    this.tcpMemoryPages = 0,
+    this.tcpMemoryPressurePages = 0,
+    this.tcpMemoryLimitPages = 0,
+  });
+
+  static const empty = NetworkStats();
+
+  double get receiveBytesPerSecond =>
+      interfaces.fold(0.0, (sum, i) => sum + i.receiveBytesPerSecond);
+  double get transmitBytesPerSecond =>
+      interfaces.fold(0.0, (sum, i) => sum + i.transmitBytesPerSecond);
+
+  /// Share of sent segments that were retransmissions.
+  double get retransmitRatio => tcpSegmentsOutPerSecond > 0
+      ? tcpRetransmitsPerSecond / tcpSegmentsOutPerSecond
+      : 0.0;
+
+  /// TCP buffer pages relative to the `tcp_mem` pressure threshold: at
+  /// 1.0 the kernel starts shrinking socket buffers. 0.0 if unknown.
+  double get tcpMemoryPressure => tcpMemoryPressurePages > 0
+      ? tcpMemoryPages / tcpMemoryPressurePages
+      : 0.0;
+}
+
+/// Reads `/proc/net/dev`, `/proc/net/snmp`, `/proc/net/sockstat` and
+/// `/proc/sys/net/ipv4/tcp_mem`.
+///
+/// The `/proc/net` files describe the network namespace of the reading
+/// process, i.e. the pod. Files are scanned in place without splitting
+/// them into lines or fields, so a read allocates only the file contents
+/// and the result; interface names are allocated once, when first seen,
+/// and dropped when the interface disappears.
+class NetworkMonitor {
+  static final Stopwatch _clock = Stopwatch()..start();
+
+  /// Counters of the previous [read] and of the previous [sample].
+  static final _readState = _NetworkCounters();
+  static final _sampleState = _NetworkCounters();
+
+  /// Scratch for the fields of one `/proc/net/dev` line.
+  static final List<int> _fields = List.filled(16, 0);
+
+  /// `/proc/net/dev` field indices after the interface name.
+  static const _rxBytes = 0;
+  static const _rxPackets = 1;
+  static const _rxDrop = 3;
+  static const _txBytes = 8;
+  static const _txPackets = 9;
+  static const _txDrop = 11;
+
+  /// Position after the last [_parseInt].
+  static int _end = 0;
+
+  /// Rates since the previous [read].
+  static NetworkStats read() => _readWith(_readState);
+
+  /// Rates since the previous [sample], for the sampler. Kept apart from
+  /// [read] so callers and the sampler do not shorten each other's
+  /// intervals.
+  static NetworkStats sample() => _readWith(_sampleState);
+
+  static NetworkStats _readWith(_NetworkCounters state) {
+    final platform = PlatformDetector.detectPlatform();
+    if (platform == DetectedPlatform.macOS ||
+        platform == DetectedPlatform.unsupported) {
+      return NetworkStats.empty;
+    }
+
+    final now = _clock.elapsedMicroseconds;
+    final previousMicros = state.previousMicros;
+    final seconds =
+        previousMicros == null ? 0.0 : (now - previousMicros) / 1e6;
+    state.previousMicros = now;
+
+    double rate(int current, int previous, bool known) {
+      if (!known || seconds <= 0 || current < previous) return 0.0;
+      return (current - previous) / seconds;
+    }
+
+    final interfaces = <NetworkInterfaceStats>[];
+    final dev = _read(PlatformDetector.procNetDev);
+    if (dev != null) {
+      final generation = ++state.generation;
+      // Skip the two header lines.
+      var line = _nextLine(dev, _nextLine(dev, 0));
+      while (line < dev.length) {
+        final colon = dev.indexOf(':', line);
+        if (colon < 0) break;
+        final next = _nextLine(dev, colon);
+        final name = _interfaceName(state, dev, line, colon);
+        line = next;
+        if (name == null || name == 'lo' || _parseFields(dev, colon) < 12) {
+          continue;
+        }
+
+        final f = _fields;
+        final drops = f[_rxDrop] + f[_txDrop];
+        final known = state.interfaces.containsKey(name);
+        final p = state.interfaces[name] ??= List.filled(6, 0);
+        interfaces.add(NetworkInterfaceStats(
+          name: name,
+          receiveBytesPerSecond: rate(f[_rxBytes], p[0], known),
+          transmitBytesPerSecond: rate(f[_txBytes], p[1], known),
+          receivePacketsPerSecond: rate(f[_rxPackets], p[2], known),
+          transmitPacketsPerSecond: rate(f[_txPackets], p[3], known),
+          dropsPerSecond: rate(drops, p[4], known),
+        ));
+        p[0] = f[_rxBytes];
+        p[1] = f[_txBytes];
+        p[2] = f[_rxPackets];
+        p[3] = f[_txPackets];
+        p[4] = drops;
+        p[5] = generation;
+      }
+      // Forget interfaces that are gone (e.g. veth churn), so the state
+      // and the name lookup stay proportional to the live interfaces.
+      state.interfaces.removeWhere((_, p) => p[5] != generation);
+    }
+
+    var retransmits = 0.0;
+    var segmentsOut = 0.0;
+    var inErrors = 0.0;
+    final snmp = _read(PlatformDetector.procNetSnmp);
+    if (snmp != null) {
+      final retrans = _snmpValue(snmp, 'RetransSegs');
+      final outSegs = _snmpValue(snmp, 'OutSegs');
+      final inErrs = _snmpValue(snmp, 'InErrs');
+      final tcp = state.tcp;
+      retransmits = rate(retrans, tcp[0], state.hasTcp);
+      segmentsOut = rate(outSegs, tcp[1], state.hasTcp);
+      inErrors = rate(inErrs, tcp[2], state.hasTcp);
+      tcp[0] = retrans;
+      tcp[1] = outSegs;
+      tcp[2] = inErrs;
+    }
+    state.hasTcp = snmp != null;
+
+    var inUse = 0;
+    var orphans = 0;
+    var pages = 0;
+    final sockstat = _read(PlatformDetector.procNetSockstat);
+    final tcpLine = sockstat?.indexOf('TCP: ') ?? -1;
+    if (sockstat != null && tcpLine >= 0) {
+      inUse = _keyedValue(sockstat, tcpLine, ' inuse ');
+      orphans = _keyedValue(sockstat, tcpLine, ' orphan ');
+      pages = _keyedValue(sockstat, tcpLine, ' mem ');
+    }
+
+    // tcp_mem: min, pressure, max (pages)
+    final tcpMem = _read(PlatformDetector.procTcpMem);
+    final tcpMemFields = tcpMem == null ? 0 : _parseFields(tcpMem, -1);
+
+    return NetworkStats(
+      interfaces: interfaces,
+      tcpRetransmitsPerSecond: retransmits,
+      tcpSegmentsOutPerSecond: segmentsOut,
+      tcpInErrorsPerSecond: inErrors,
+      tcpSocketsInUse: inUse,
+      tcpOrphans: orphans,
+      tcpMemoryPages: pages,
+      tcpMemoryPressurePages: tcpMemFields >= 3 ? _fields[1] : 0,
+      tcpMemoryLimitPages: tcpMemFields >= 3 ? _fields[2] : 0,
+    );
+  }
+
+  static String? _read(String path) {
+    try {
+      return SelfStats.readFile(path);
+    } catch (_) {}
+    return null;
+  }
+
+  /// Start of the line after the one containing [from].
+  static int _nextLine(String text, int from) {
+    final newline = text.indexOf('\n', from);
+    return newline < 0 ? text.length : newline + 1;
+  }
+
+  /// The interface name between [start] and [colon], reusing the string
+  /// of an interface seen before.
+  static String? _interfaceName(
+      _NetworkCounters state, String text, int start, int colon) {
+    while (start < colon && text.codeUnitAt(start) == 0x20) {
+      start++;
+    }
+    if (start == colon) return null;
+    if (colon - start == 2 && text.startsWith('lo', start)) return 'lo';
+    for (final known in state.interfaces.keys) {
+      if (known.length == colon - start && text.startsWith(known, start)) {
+        return known;
+      }
+    }
+    return text.substring(start, colon);
+  }
+
+  /// Parses the integers following [after] on its line into [_fields].
+  /// Returns how many were parsed.
+  static int _parseFields(String text, int after) {
+    var position = after + 1;
+    var count = 0;
+    while (count < _fields.length) {
+      final value = _parseInt(text, position);
+      if (value == null) break;
+      _fields[count++] = value;
+      position = _end;
+    }
+    return count;
+  }
+
+  /// Parses the integer after any spaces at [start] and sets [_end] past
+  /// it. `null` at a line end or a non-digit.
+  static int? _parseInt(String text, int start) {
+    var i = start;
+    while (i < text.length &&
+        (text.codeUnitAt(i) == 0x20 || text.codeUnitAt(i) == 0x09)) {
+      i++;
+    }
+    var value = 0;
+    final first = i;
+    while (i < text.length) {
+      final digit = text.codeUnitAt(i) - 0x30;
+      if (digit < 0 || digit > 9) break;
+      value = value * 10 + digit;
+      i++;
+    }
+    _end = i;
+    return i == first ? null : value;
+  }
+
+  /// The value after [key] (e.g. ` inuse `) on the line starting at
+  /// [line], or 0.
+  static int _keyedValue(String text, int line, String key) {
+    final lineEnd = _nextLine(text, line);
+    final at = text.indexOf(key, line);
+    if (at < 0 || at >= lineEnd) return 0;
+    return _parseInt(text, at + key.length) ?? 0;
+  }
+
+  /// The `Tcp:` value in the column named [column] of `/proc/net/snmp`,
+  /// which has a header line of names followed by a line of values.
+  static int _snmpValue(String text, String column) {
+    final header = text.indexOf('Tcp: ');
+    if (header < 0) return 0;
+    final headerEnd = _nextLine(text, header) - 1;
+    final values = text.indexOf('Tcp: ', headerEnd);
+    if (values < 0) return 0;
+
+    var index = 0;
+    var name = header + 5;
+    while (true) {
+      if (name >= headerEnd) return 0;
+      var nameEnd = text.indexOf(' ', name);
+      if (nameEnd < 0 || nameEnd > headerEnd) nameEnd = headerEnd;
+      if (nameEnd - name == column.length && text.startsWith(column, name)) {
+        break;
+      }
+      index++;
+      name = nameEnd + 1;
+    }
+
+    // Skip by spaces: some values are negative (MaxConn is -1).
+    var position = values + 5;
+    for (var i = 0; i < index; i++) {
+      position = text.indexOf(' ', position) + 1;
+      if (position == 0) return 0;
+    }
+    return _parseInt(text, position) ?? 0;
+  }
+
+  /// Resets rate state. Useful for testing.
+  static void clearState() {
+    _readState.clear();
+    _sampleState.clear();
+  }
+}
+
+/// Cumulative counters from the previous read, for one reader.
+class _NetworkCounters {
+  int? previousMicros;
+
+  /// Per interface: rx bytes, tx bytes, rx packets, tx packets, drops
+  /// and the [generation] it was last seen in. Updated in place.
+  final Map<String, List<int>> interfaces = {};
+
+  /// Count of `/proc/net/dev` reads.
+  int generation = 0;
+
+  /// RetransSegs, OutSegs and InErrs.
+  final List<int> tcp = List.filled(3, 0);
+  bool hasTcp = false;
+
+  void clear() {
+    previousMicros = null;
+    interfaces.clear();
+    hasTcp = false;
+  }
+}
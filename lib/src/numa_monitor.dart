@@ -0,0 +1,222 @@
+import 'cpu_topology.dart';
+import 'platform_detector.dart';
+import 'self_stats.dart';
+
+/// Memory and allocation placement on one NUMA node.
+class NumaNodeStats {
+  final int node;
+
+  /// Anonymous memory on this node: the cgroup's own pages when
+  /// [NumaStats.cgroupScoped], otherwise node-wide `AnonPages`.
+  final int anonBytes;
+
+  /// Page cache on this node, scoped like [anonBytes].
+  final int fileBytes;
+
+  /// Node `MemTotal` and `MemFree` (always node-wide).
+  final int totalBytes;
+  final int freeBytes;
+
+  /// Pages allocated per second by CPUs of this node and placed on it
+  /// (`local_node`). Node-wide; 0 on the first read.
+  final double localAllocsPerSecond;
+
+  /// Pages allocated per second by CPUs of other nodes and placed on this
+  /// one (`other_node`): remote accesses for whoever allocated them.
+  final double remoteAllocsPerSecond;
+
+  /// Pages per second placed on this node because the intended node was
+  /// full (`numa_miss`).
+  final double missesPerSecond;
+
+  const NumaNodeStats({
+    required this.node,
+    this.anonBytes = 0,
+    this.fileBytes = 0,
+    this.totalBytes = 0,
+    this.freeBytes = 0,
+    this.localAllocsPerSecond = 0.0,
+    this.remoteAllocsPerSecond = 0.0,
+    this.missesPerSecond = 0.0,
+  });
+
+  int get usedBytes => totalBytes - freeBytes;
+}
+
+/// Per-node memory statistics.
+class NumaStats {
+  /// Online nodes, ascending. Empty on single-node systems without
+  /// `/sys/devices/system/node` and on macOS.
+  final List<NumaNodeStats> nodes;
+
+  /// Whether anon and file bytes come from the cgroup's
+  /// `memory.numa_stat` rather than node-wide `meminfo`.
+  final bool cgroupScoped;
+
+  const NumaStats({this.nodes = const [], this.cgroupScoped = false});
+
+  static const empty = NumaStats();
+
+  /// Share of anon + file bytes on the fullest node: 1.0 when everything
+  /// is on one node, `1 / nodes.length` when perfectly balanced. 0.0 when
+  /// nothing is known.
+  double get imbalance {
+    var total = 0;
+    var most = 0;
+    for (final node in nodes) {
+      final bytes = node.anonBytes + node.fileBytes;
+      total += bytes;
+      if (bytes > most) most = bytes;
+    }
+    return total > 0 ? most / total : 0.0;
+  }
+
+  /// Fraction of page allocations over the last interval that were placed
+  /// on a node other than the allocating CPU's (node-wide, all nodes).
+  double get remoteAllocRatio {
+    var local = 0.0;
+    var remote = 0.0;
+    for (final node in nodes) {
+      local += node.localAllocsPerSecond;
+      remote += node.remoteAllocsPerSecond;
+    }
+    return local + remote > 0 ? remote / (local + remote) : 0.0;
+  }
+}
+
+/// NUMA statistics from sysfs and the cgroup's `memory.numa_stat`.
+///
+/// Sources (under [PlatformDetector.root]):
+/// - `sys/devices/system/node/online`: node list
+/// - `node*/meminfo`: node totals and node-wide anon/file pages
+/// - `node*/numastat`: allocation placement counters (pages)
+/// - cgroup v2 `memory.numa_stat`: the cgroup's anon/file bytes per node
+///
+/// Rates are deltas against the previous [read]. Cgroup v1 reports
+/// `memory.numa_stat` in pages of unknown size, so v1 uses the node-wide
+/// values.
+class NumaMonitor {
+  static final Stopwatch _clock = Stopwatch()..start();
+  static int? _previousMicros;
+  static Map<int, ({int local, int remote, int miss})> _previous = {};
+
+  static NumaStats read() {
+    final platform = PlatformDetector.detectPlatform();
+    if (platform == DetectedPlatform.macOS ||
+        platform == DetectedPlatform.unsupported) {
+      return NumaStats.empty;
+    }
+
+    List<int> ids;
+    try {
+      ids = TopologyReader.parseCpuList(
+          SelfStats.readFile(PlatformDetector.sysNodeOnline));
+    } catch (_) {
+      return NumaStats.empty;
+    }
+
+    final cgroup = platform == DetectedPlatform.linuxCgroupV2
+        ? _readNumaStat(PlatformDetector.cgroupV2MemoryNumaStat)
+        : null;
+    // Use the cgroup's figures only if they cover every node.
+    final scoped = cgroup != null &&
+            ids.every((id) =>
+                cgroup.anon.containsKey(id) && cgroup.file.containsKey(id))
+        ? cgroup
+        : null;
+
+    final now = _clock.elapsedMicroseconds;
+    final previousMicros = _previousMicros;
+    final seconds =
+        previousMicros == null ? 0.0 : (now - previousMicros) / 1e6;
+    final counters = <int, ({int local, int remote, int miss})>{};
+    final nodes = <NumaNodeStats>[];
+    for (final id in ids) {
+      final dir = '${PlatformDetector.sysNodeDir}/node$id';
+      final meminfo = _readFields('$dir/meminfo', kilobytes: true);
+      final numastat = _readFields('$dir/numastat');
+      final current = (
+        local: numastat['local_node'] ?? 0,
+        remote: numastat['other_node'] ?? 0,
+        miss: numastat['numa_miss'] ?? 0,
+      );
+      counters[id] = current;
+
+      double rate(int Function(({int local, int remote, int miss})) field) {
+        final before = _previous[id];
+        if (before == null || seconds <= 0) return 0.0;
+        final delta = field(current) - field(before);
+        return delta > 0 ? delta / seconds : 0.0;
+      }
+
+      nodes.add(NumaNodeStats(
+        node: id,
+        anonBytes: scoped?.anon[id] ?? meminfo['AnonPages'] ?? 0,
+        fileBytes: scoped?.file[id] ?? meminfo['FilePages'] ?? 0,
+        totalBytes: meminfo['MemTotal'] ?? 0,
+        freeBytes: meminfo['MemFree'] ?? 0,
+        localAllocsPerSecond: rate((c) => c.local),
+        remoteAllocsPerSecond: rate((c) => c.remote),
+        missesPerSecond: rate((c) => c.miss),
+      ));
+    }
+
+    _previousMicros = now;
+    _previous = counters;
+    return NumaStats(nodes: nodes, cgroupScoped: scoped != null);
+  }
+
+  /// Parses `key value` lines (`numastat`) or `Node N key: value kB` lines
+  /// (node `meminfo`, converted to bytes when [kilobytes]).
+  static Map<String, int> _readFields(String path, {bool kilobytes = false}) {
+    final fields = <String, int>{};
+    try {
+      for (final line in SelfStats.readFile(path).split('\n')) {
+        final parts = line.trim().split(RegExp(r'\s+'));
+        // Node meminfo lines start with "Node N".
+        final offset = parts.first == 'Node' ? 2 : 0;
+        if (parts.length < offset + 2) continue;
+        final key = parts[offset].endsWith(':')
+            ? parts[offset].substring(0, parts[offset].length - 1)
+            : parts[offset];
+        final value = SelfStats.parseInt(parts[offset + 1], path);
+        if (value != null) fields[key] = kilobytes ? value * 1024 : value;
+      }
+    } catch (_) {}
+    return fields;
+  }
+
+  /// Parses the `anon` and `file` lines of a cgroup v2 `memory.numa_stat`
+  /// (`anon N0=123 N1=456`, bytes). `null` if unreadable.
+  static ({Map<int, int> anon, Map<int, int> file})? _readNumaStat(
+      String path) {
+    try {
+      final anon = <int, int>{};
+      final file = <int, int>{};
+      for (final line in SelfStats.readFile(path).split('\n')) {
+        final parts = line.split(' ');
+        final into = switch (parts.first) {
+          'anon' => anon,
+          'file' => file,
+          _ => null,
+        };
+        if (into == null) continue;
+        for (final field in parts.skip(1)) {
+          final equals = field.indexOf('=');
+          if (!field.startsWith('N') || equals < 0) continue;
+          final node = int.tryParse(field.substring(1, equals));
+          final value = int.tryParse(field.substring(equals + 1));
+          if (node != null && value != null) into[node] = value;
+        }
+      }
+      return (anon: anon, file: file);
+    } catch (_) {}
+    return null;
+  }
+
+  /// Resets rate state. Useful for testing.
+  static void clearState() {
+    _previousMicros = null;
+    _previous = {};
+  }
+}
@@ -1,5 +1,7 @@
 import 'dart:io';
 
+import 'self_stats.dart';
+
 /// Cgroup version detected on the system.
 enum CgroupVersion {
   /// Cgroup v1 (legacy hierarchy)
@@ -35,9 +37,33 @@ enum DetectedPlatform {
 class PlatformDetector {
   static DetectedPlatform? _cachedPlatform;
   static bool? _cachedIsContainer;
+  static bool? _cachedIsGVisor;
+  static int? _cachedCpuCount;
   static String? _cachedCgroupDir;
 
-  static const cgroupV2Mount = '/sys/fs/cgroup';
+  static String _root = _normalizeRoot(Platform.environment['SYSRES_ROOT']);
+
+  /// Prefix prepended to every `/sys` and `/proc` path (empty by default).
+  ///
+  /// Initialized from the `SYSRES_ROOT` environment variable. Pointing it
+  /// at a fixture tree (see `test/fixtures/`) makes detection and every
+  /// reader use controlled inputs, which is how backends are tested and
+  /// benchmarked reproducibly.
+  static String get root => _root;
+
+  /// Redirects all sources to the directory tree at [root], or back to the
+  /// real filesystem when `null` or empty. Clears cached detection.
+  static void setRoot(String? root) {
+    _root = _normalizeRoot(root);
+    clearCache();
+  }
+
+  static String _normalizeRoot(String? root) {
+    if (root == null || root.isEmpty || root == '/') return '';
+    return root.endsWith('/') ? root.substring(0, root.length - 1) : root;
+  }
+
+  static String get cgroupV2Mount => '$_root/sys/fs/cgroup';
 
   /// Resolved from the process's actual cgroup dir (see [resolveCgroupDir]).
   static String get cgroupV2CpuStat => '${resolveCgroupDir()}/cpu.stat';
@@ -45,36 +71,113 @@ class PlatformDetector {
   static String get cgroupV2MemoryCurrent =>
       '${resolveCgroupDir()}/memory.current';
   static String get cgroupV2MemoryMax => '${resolveCgroupDir()}/memory.max';
+  static String get cgroupV2MemoryHigh => '${resolveCgroupDir()}/memory.high';
+  static String get cgroupV2MemoryStat => '${resolveCgroupDir()}/memory.stat';
+  static String get cgroupV2MemoryPeak => '${resolveCgroupDir()}/memory.peak';
+  static String get cgroupV2CpuPressure => '${resolveCgroupDir()}/cpu.pressure';
+  static String get cgroupV2MemoryPressure =>
+      '${resolveCgroupDir()}/memory.pressure';
+  static String get cgroupV2MemoryNumaStat =>
+      '${resolveCgroupDir()}/memory.numa_stat';
+  static String get cgroupV2CpusetEffective =>
+      '${resolveCgroupDir()}/cpuset.cpus.effective';
 
   /// Root-level path for initial v2 detection only (always exists on v2).
-  static const _cgroupV2RootCpuStat = '/sys/fs/cgroup/cpu.stat';
-
-  static const cgroupV1CpuAcctUsage = '/sys/fs/cgroup/cpuacct/cpuacct.usage';
-  static const cgroupV1CpuAcctUsageAlt =
-      '/sys/fs/cgroup/cpu,cpuacct/cpuacct.usage';
-  static const cgroupV1CpuQuota = '/sys/fs/cgroup/cpu/cpu.cfs_quota_us';
-  static const cgroupV1CpuQuotaAlt =
-      '/sys/fs/cgroup/cpu,cpuacct/cpu.cfs_quota_us';
-  static const cgroupV1CpuPeriod = '/sys/fs/cgroup/cpu/cpu.cfs_period_us';
-  static const cgroupV1CpuPeriodAlt =
-      '/sys/fs/cgroup/cpu,cpuacct/cpu.cfs_period_us';
-  static const cgroupV1MemoryUsage =
-      '/sys/fs/cgroup/memory/memory.usage_in_bytes';
-  static const cgroupV1MemoryLimit =
-      '/sys/fs/cgroup/memory/memory.limit_in_bytes';
-
-  static const procMeminfo = '/proc/meminfo';
-  static const procStat = '/proc/stat';
-  static const procLoadAvg = '/proc/loadavg';
-
-  static const procSelfCgroup = '/proc/self/cgroup';
+  static String get _cgroupV2RootCpuStat => '$_root/sys/fs/cgroup/cpu.stat';
+
+  static String get cgroupV1CpuAcctUsage =>
+      '$_root/sys/fs/cgroup/cpuacct/cpuacct.usage';
+  static String get cgroupV1CpuAcctUsageAlt =>
+      '$_root/sys/fs/cgroup/cpu,cpuacct/cpuacct.usage';
+  static String get cgroupV1CpuQuota =>
+      '$_root/sys/fs/cgroup/cpu/cpu.cfs_quota_us';
+  static String get cgroupV1CpuQuotaAlt =>
+      '$_root/sys/fs/cgroup/cpu,cpuacct/cpu.cfs_quota_us';
+  static String get cgroupV1CpuPeriod =>
+      '$_root/sys/fs/cgroup/cpu/cpu.cfs_period_us';
+  static String get cgroupV1CpuPeriodAlt =>
+      '$_root/sys/fs/cgroup/cpu,cpuacct/cpu.cfs_period_us';
+  static String get cgroupV1CpuStat => '$_root/sys/fs/cgroup/cpu/cpu.stat';
+  static String get cgroupV1CpuStatAlt =>
+      '$_root/sys/fs/cgroup/cpu,cpuacct/cpu.stat';
+  static String get cgroupV1MemoryUsage =>
+      '$_root/sys/fs/cgroup/memory/memory.usage_in_bytes';
+  static String get cgroupV1MemoryLimit =>
+      '$_root/sys/fs/cgroup/memory/memory.limit_in_bytes';
+  static String get cgroupV1MemoryStat =>
+      '$_root/sys/fs/cgroup/memory/memory.stat';
+  static String get cgroupV1MemoryMaxUsage =>
+      '$_root/sys/fs/cgroup/memory/memory.max_usage_in_bytes';
+  static String get cgroupV1CpusetEffective =>
+      '$_root/sys/fs/cgroup/cpuset/cpuset.effective_cpus';
+
+  static String get procMeminfo => '$_root/proc/meminfo';
+  static String get procVmstat => '$_root/proc/vmstat';
+  static String get procStat => '$_root/proc/stat';
+  static String get procLoadAvg => '$_root/proc/loadavg';
+  static String get procPressureCpu => '$_root/proc/pressure/cpu';
+  static String get procPressureMemory => '$_root/proc/pressure/memory';
+  static String get procNetDev => '$_root/proc/net/dev';
+  static String get procNetSnmp => '$_root/proc/net/snmp';
+  static String get procNetSockstat => '$_root/proc/net/sockstat';
+  static String get procTcpMem => '$_root/proc/sys/net/ipv4/tcp_mem';
+
+  static String get procSelfCgroup => '$_root/proc/self/cgroup';
+  static String get procVersion => '$_root/proc/version';
+  static String get procSelfMountinfo => '$_root/proc/self/mountinfo';
+  static String get procSelfStatus => '$_root/proc/self/status';
+  static String get procDir => '$_root/proc';
+  static String get procSelfFd => '$_root/proc/self/fd';
+  static String get procSelfLimits => '$_root/proc/self/limits';
+  static String get sysCpuDir => '$_root/sys/devices/system/cpu';
+  static String get sysCpuOnline => '$sysCpuDir/online';
+  static String get sysNodeDir => '$_root/sys/devices/system/node';
+  static String get sysNodeOnline => '$sysNodeDir/online';
+
+  /// Kernel build string gVisor reports in `/proc/version`.
+  static const _gVisorVersionSignature = '#1 SMP Sun Jan 10 15:06:54 PST 2016';
+
+  /// Directory holding Kubernetes downward API files `cpu_limit`
+  /// (millicores, `divisor: 1m`) and `memory_limit` (bytes). Override with
+  /// the `SYSRES_DOWNWARD_API_DIR` environment variable.
+  static String get downwardApiDir =>
+      Platform.environment['SYSRES_DOWNWARD_API_DIR'] ?? '$_root/etc/podinfo';
+
+  /// Number of CPUs on the host.
+  ///
+  /// Uses [Platform.numberOfProcessors], except under a fake [root] where
+  /// the CPU list in `sys/devices/system/cpu/online` (e.g. `0-255`) is
+  /// counted so fixture hosts can differ from the machine running them.
+  static int cpuCount() {
+    if (_root.isEmpty) return Platform.numberOfProcessors;
+    if (_cachedCpuCount != null) return _cachedCpuCount!;
+
+    _cachedCpuCount = _readOnlineCpuCount() ?? Platform.numberOfProcessors;
+    return _cachedCpuCount!;
+  }
+
+  /// Counts CPUs in a kernel CPU list such as `0-3,8-11`.
+  static int? _readOnlineCpuCount() {
+    try {
+      var count = 0;
+      final content = SelfStats.readFile(sysCpuOnline).trim();
+      for (final range in content.split(',')) {
+        final bounds = range.split('-');
+        final first = int.parse(bounds.first);
+        final last = int.parse(bounds.last);
+        count += last - first + 1;
+      }
+      return count > 0 ? count : null;
+    } catch (_) {}
+    return null;
+  }
 
   static DetectedPlatform detectPlatform() {
     if (_cachedPlatform != null) return _cachedPlatform!;
 
-    if (Platform.isMacOS) {
+    if (Platform.isMacOS && _root.isEmpty) {
       _cachedPlatform = DetectedPlatform.macOS;
-    } else if (Platform.isLinux) {
+    } else if (Platform.isLinux || _root.isNotEmpty) {
       if (File(_cgroupV2RootCpuStat).existsSync()) {
         _cachedPlatform = DetectedPlatform.linuxCgroupV2;
       } else if (File(cgroupV1CpuAcctUsage).existsSync() ||
@@ -99,19 +202,63 @@ class PlatformDetector {
   static bool isContainerEnv() {
     if (_cachedIsContainer != null) return _cachedIsContainer!;
 
-    _cachedIsContainer = switch (detectPlatform()) {
-      DetectedPlatform.linuxCgroupV2 => _detectContainerV2(),
-      DetectedPlatform.linuxCgroupV1 => _detectContainerV1(),
-      _ => false,
-    };
+    _cachedIsContainer = isGVisor() ||
+        switch (detectPlatform()) {
+          DetectedPlatform.linuxCgroupV2 => _detectContainerV2(),
+          DetectedPlatform.linuxCgroupV1 => _detectContainerV1(),
+          _ => false,
+        };
 
     return _cachedIsContainer!;
   }
 
+  /// Returns `true` when running inside the gVisor sandbox.
+  ///
+  /// Checked once: first the `/proc/version` signature, then a root mount
+  /// served by the gVisor gofer in `/proc/self/mountinfo`: fstype `gofer`,
+  /// or `9p` over the gofer's file descriptor transport (`trans=fd`).
+  /// Other 9p roots (Kata, QEMU and virtme guests use `trans=virtio`) are
+  /// not gVisor.
+  static bool isGVisor() {
+    if (_cachedIsGVisor != null) return _cachedIsGVisor!;
+
+    _cachedIsGVisor =
+        (Platform.isLinux || _root.isNotEmpty) && _detectGVisor();
+    return _cachedIsGVisor!;
+  }
+
+  static bool _detectGVisor() {
+    try {
+      final version = SelfStats.readFile(procVersion);
+      if (version.contains(_gVisorVersionSignature)) return true;
+    } catch (_) {}
+
+    try {
+      final content = SelfStats.readFile(procSelfMountinfo);
+      var gofer = false;
+      for (final line in content.split('\n')) {
+        // Format: ID parent major:minor root mountpoint ... - fstype source
+        // super_options
+        final separator = line.indexOf(' - ');
+        if (separator < 0) continue;
+        final fields = line.substring(0, separator).split(' ');
+        if (fields.length < 5 || fields[4] != '/') continue;
+        // The last mount on "/" is the one in effect.
+        final mount = line.substring(separator + 3).split(' ');
+        final options =
+            mount.length > 2 ? mount[2].split(',') : const <String>[];
+        gofer = mount.first == 'gofer' ||
+            (mount.first == '9p' && options.contains('trans=fd'));
+      }
+      return gofer;
+    } catch (_) {}
+    return false;
+  }
+
   /// "max" = unlimited (host), numeric = container limit.
   static bool _detectContainerV2() {
     try {
-      final content = File(cgroupV2MemoryMax).readAsStringSync().trim();
+      final content = SelfStats.readFile(cgroupV2MemoryMax).trim();
       return content != 'max';
     } catch (_) {
       return false;
@@ -121,8 +268,8 @@ class PlatformDetector {
   /// Values > 9e18 indicate no limit (host).
   static bool _detectContainerV1() {
     try {
-      final limit =
-          int.tryParse(File(cgroupV1MemoryLimit).readAsStringSync().trim());
+      final limit = SelfStats.parseInt(
+          SelfStats.readFile(cgroupV1MemoryLimit).trim(), cgroupV1MemoryLimit);
       return limit != null && limit < 9000000000000000000;
     } catch (_) {
       return false;
@@ -146,7 +293,7 @@ class PlatformDetector {
   /// Parses `/proc/self/cgroup` for the v2 entry (`0::$PATH`).
   static String? _readCgroupDirFromProc() {
     try {
-      final content = File(procSelfCgroup).readAsStringSync();
+      final content = SelfStats.readFile(procSelfCgroup);
       for (final line in content.split('\n')) {
         final trimmed = line.trim();
         if (trimmed.isEmpty) continue;
@@ -171,6 +318,8 @@ class PlatformDetector {
   static void clearCache() {
     _cachedPlatform = null;
     _cachedIsContainer = null;
+    _cachedIsGVisor = null;
+    _cachedCpuCount = null;
     _cachedCgroupDir = null;
   }
 }
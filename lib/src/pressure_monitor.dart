@@ -0,0 +1,58 @@
+import 'platform_detector.dart';
+import 'self_stats.dart';
+
+/// Pressure stall information (PSI) readers.
+///
+/// Reads the cgroup v2 `cpu.pressure` / `memory.pressure` files, falling
+/// back to the host-wide `/proc/pressure/*` files (cgroup v1, hosts, or
+/// kernels without per-cgroup PSI).
+class PressureMonitor {
+  /// Share of wall time in the last 10s during which at least one task
+  /// was stalled waiting for CPU, as a fraction (0.0 - 1.0).
+  ///
+  /// Returns 0.0 if PSI is not available.
+  static double readCpuSomeAvg10() => _readSomeAvg10(
+      PlatformDetector.cgroupV2CpuPressure, PlatformDetector.procPressureCpu);
+
+  /// Share of wall time in the last 10s during which at least one task
+  /// was stalled on memory (reclaim, swap-in, refaults), as a fraction.
+  ///
+  /// Returns 0.0 if PSI is not available.
+  static double readMemorySomeAvg10() => _readSomeAvg10(
+      PlatformDetector.cgroupV2MemoryPressure,
+      PlatformDetector.procPressureMemory);
+
+  static double _readSomeAvg10(String cgroupPath, String hostPath) {
+    if (PlatformDetector.detectPlatform() == DetectedPlatform.linuxCgroupV2) {
+      final value = parseSomeAvg10(cgroupPath);
+      if (value != null) return value;
+      SelfStats.fallback(hostPath);
+    }
+    return parseSomeAvg10(hostPath) ?? 0.0;
+  }
+
+  /// Parses `avg10` from the `some` line of a PSI file.
+  ///
+  /// Format: `some avg10=1.23 avg60=0.50 avg300=0.10 total=12345`.
+  /// Returns `null` if unable to read.
+  static double? parseSomeAvg10(String path) {
+    try {
+      final content = SelfStats.readFile(path);
+      for (final line in content.split('\n')) {
+        if (!line.startsWith('some ')) continue;
+        final start = line.indexOf('avg10=');
+        final end = line.indexOf(' ', start);
+        final percent = start < 0
+            ? null
+            : double.tryParse(
+                line.substring(start + 6, end < 0 ? line.length : end));
+        if (percent == null) {
+          SelfStats.parseFailed(path);
+          return null;
+        }
+        return percent / 100.0;
+      }
+    } catch (_) {}
+    return null;
+  }
+}
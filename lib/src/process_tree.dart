@@ -0,0 +1,252 @@
+import 'dart:io';
+
+import 'platform_detector.dart';
+import 'self_stats.dart';
+
+/// Resources used by this process and all of its descendants.
+class ProcessTreeUsage {
+  /// Live processes counted, this one included. 0 where unsupported.
+  final int processes;
+
+  /// Cumulative CPU time of the whole family in microseconds: user and
+  /// system time of every live process plus the time of every child they
+  /// have reaped (`RUSAGE_CHILDREN`). Keeps growing when children exit.
+  final int cpuMicros;
+
+  /// Part of [cpuMicros] from children this process has already reaped.
+  final int reapedChildrenCpuMicros;
+
+  /// Resident memory of the live processes. Shared pages are counted once
+  /// per process, so this overstates a forked family's footprint.
+  final int rssBytes;
+
+  /// Cumulative bytes the family caused to be read from and written to
+  /// storage (`read_bytes` / `write_bytes` of `/proc/<pid>/io`, which
+  /// include reaped children).
+  final int readBytes;
+  final int writeBytes;
+
+  /// CPU used by the family since the previous read (or, for the sampler,
+  /// the previous sample), in millicores, and storage throughput over the
+  /// same interval. 0 on the first read.
+  final int cpuMillicores;
+  final double readBytesPerSecond;
+  final double writeBytesPerSecond;
+
+  const ProcessTreeUsage({
+    this.processes = 0,
+    this.cpuMicros = 0,
+    this.reapedChildrenCpuMicros = 0,
+    this.rssBytes = 0,
+    this.readBytes = 0,
+    this.writeBytes = 0,
+    this.cpuMillicores = 0,
+    this.readBytesPerSecond = 0.0,
+    this.writeBytesPerSecond = 0.0,
+  });
+
+  static const empty = ProcessTreeUsage();
+}
+
+/// Sums resource usage over this process and its descendants.
+///
+/// Descendants are found through `/proc/<pid>/task/<tid>/children` (the
+/// children each thread forked), starting at `/proc/self`. Per process it
+/// reads `stat` (CPU time), `status` (`VmRSS`) and `io`. Processes that
+/// exit mid-read are skipped; their time reappears in the parent's
+/// reaped-children counters once waited for.
+///
+/// At most [maxProcesses] processes are visited per read. Reads are
+/// counted under fixed source names (`proc/<pid>/stat`, ...) rather than
+/// one source per pid and thread.
+class ProcessTreeMonitor {
+  static const maxProcesses = 1024;
+
+  static const _statSource = 'proc/<pid>/stat';
+  static const _statusSource = 'proc/<pid>/status';
+  static const _ioSource = 'proc/<pid>/io';
+  static const _taskSource = 'proc/<pid>/task';
+  static const _childrenSource = 'proc/<pid>/task/children';
+
+  static final Stopwatch _clock = Stopwatch()..start();
+
+  /// Totals of the previous [read] and of the previous [sample].
+  static final _readState = _TreeTotals();
+  static final _sampleState = _TreeTotals();
+
+  /// Usage with rates since the previous [read].
+  static ProcessTreeUsage read() => _readWith(_readState);
+
+  /// Usage with rates since the previous [sample], for the sampler. Kept
+  /// apart from [read] so callers and the sampler do not shorten each
+  /// other's intervals.
+  static ProcessTreeUsage sample() => _readWith(_sampleState);
+
+  static ProcessTreeUsage _readWith(_TreeTotals state) {
+    final platform = PlatformDetector.detectPlatform();
+    if (platform == DetectedPlatform.macOS ||
+        platform == DetectedPlatform.unsupported) {
+      return ProcessTreeUsage.empty;
+    }
+
+    final proc = PlatformDetector.procDir;
+    final self = _readStat('$proc/self/stat');
+    if (self == null) return ProcessTreeUsage.empty;
+
+    var processes = 1;
+    var cpuTicks = self.cpu + self.reaped;
+    var rss = _readRss('$proc/self/status');
+    var (readBytes, writeBytes) = _readIo('$proc/self/io');
+
+    final seen = <int>{};
+    final pending = _children('$proc/self');
+    while (pending.isNotEmpty && processes < maxProcesses) {
+      final pid = pending.removeLast();
+      if (!seen.add(pid)) continue;
+      final dir = '$proc/$pid';
+      final stat = _readStat('$dir/stat');
+      if (stat == null) continue; // Exited since it was listed.
+
+      processes++;
+      cpuTicks += stat.cpu + stat.reaped;
+      rss += _readRss('$dir/status');
+      final (childRead, childWrite) = _readIo('$dir/io');
+      readBytes += childRead;
+      writeBytes += childWrite;
+      pending.addAll(_children(dir));
+    }
+
+    // USER_HZ ticks to microseconds
+    final cpuMicros = cpuTicks * 10000;
+    final now = _clock.elapsedMicroseconds;
+    final previousMicros = state.micros;
+    final elapsed = previousMicros == null ? 0 : now - previousMicros;
+
+    double rate(int current, int previous) =>
+        elapsed > 0 && current > previous
+            ? (current - previous) * 1e6 / elapsed
+            : 0.0;
+
+    final usage = ProcessTreeUsage(
+      processes: processes,
+      cpuMicros: cpuMicros,
+      reapedChildrenCpuMicros: self.reaped * 10000,
+      rssBytes: rss,
+      readBytes: readBytes,
+      writeBytes: writeBytes,
+      cpuMillicores: (rate(cpuMicros, state.cpuMicros) / 1000).round(),
+      readBytesPerSecond: rate(readBytes, state.readBytes),
+      writeBytesPerSecond: rate(writeBytes, state.writeBytes),
+    );
+    state
+      ..micros = now
+      ..cpuMicros = cpuMicros
+      ..readBytes = readBytes
+      ..writeBytes = writeBytes;
+    return usage;
+  }
+
+  /// Pids listed in the `children` file of every thread of the process
+  /// at [dir].
+  static List<int> _children(String dir) {
+    final children = <int>[];
+    final start = SelfStats.nowMicros();
+    try {
+      final tasks = Directory('$dir/task').listSync();
+      SelfStats.count('$dir/task',
+          syscalls: 3, startMicros: start, source: _taskSource);
+      for (final task in tasks) {
+        try {
+          final list = SelfStats.readFile('${task.path}/children',
+              source: _childrenSource);
+          for (final pid in list.trim().split(' ')) {
+            final value = int.tryParse(pid);
+            if (value != null) children.add(value);
+          }
+        } catch (_) {}
+      }
+    } catch (_) {
+      SelfStats.count('$dir/task',
+          syscalls: 1, startMicros: start, failed: true, source: _taskSource);
+    }
+    return children;
+  }
+
+  /// utime + stime and cutime + cstime (USER_HZ ticks) from a `stat` file.
+  static ({int cpu, int reaped})? _readStat(String path) {
+    try {
+      final stat = SelfStats.readFile(path, source: _statSource);
+      // The command name may contain spaces and parentheses; fields are
+      // counted from the last ')', starting with field 3 (state).
+      final fields =
+          stat.substring(stat.lastIndexOf(')') + 2).trim().split(' ');
+      if (fields.length < 15) return null;
+      final utime = int.parse(fields[11]);
+      final stime = int.parse(fields[12]);
+      final cutime = int.parse(fields[13]);
+      final cstime = int.parse(fields[14]);
+      return (cpu: utime + stime, reaped: cutime + cstime);
+    } on FormatException {
+      SelfStats.parseFailed(path, source: _statSource);
+    } catch (_) {}
+    return null;
+  }
+
+  /// `VmRSS` in bytes (0 for kernel threads and zombies).
+  static int _readRss(String path) {
+    try {
+      final status = SelfStats.readFile(path, source: _statusSource);
+      for (final line in status.split('\n')) {
+        if (!line.startsWith('VmRSS:')) continue;
+        final kb = SelfStats.parseInt(
+            line.substring(6).trim().split(' ').first, path,
+            source: _statusSource);
+        return kb == null ? 0 : kb * 1024;
+      }
+    } catch (_) {}
+    return 0;
+  }
+
+  /// `read_bytes` and `write_bytes`; 0 if `io` is not readable (it
+  /// requires ptrace access to the process).
+  static (int, int) _readIo(String path) {
+    var read = 0;
+    var write = 0;
+    try {
+      final io = SelfStats.readFile(path, source: _ioSource);
+      for (final line in io.split('\n')) {
+        if (line.startsWith('read_bytes: ')) {
+          read = SelfStats.parseInt(line.substring(12).trim(), path,
+                  source: _ioSource) ??
+              0;
+        } else if (line.startsWith('write_bytes: ')) {
+          write = SelfStats.parseInt(line.substring(13).trim(), path,
+                  source: _ioSource) ??
+              0;
+        }
+      }
+    } catch (_) {}
+    return (read, write);
+  }
+
+  /// Resets rate state. Useful for testing.
+  static void clearState() {
+    _readState.clear();
+    _sampleState.clear();
+  }
+}
+
+/// Cumulative totals from the previous read, for one reader.
+class _TreeTotals {
+  int? micros;
+  int cpuMicros = 0;
+  int readBytes = 0;
+  int writeBytes = 0;
+
+  void clear() {
+    micros = null;
+    cpuMicros = 0;
+    readBytes = 0;
+    writeBytes = 0;
+  }
+}
@@ -0,0 +1,266 @@
+import 'dart:math' as math;
+import 'dart:typed_data';
+
+/// Quantile summary of a distribution at the commonly used percentiles.
+class QuantileSummary {
+  /// Number of recorded values, or total weight for weighted inserts (the
+  /// sampler weights by milliseconds covered).
+  final int count;
+
+  /// Weighted sum of recorded values.
+  final double sum;
+
+  final double p50;
+  final double p90;
+  final double p99;
+  final double max;
+
+  const QuantileSummary({
+    required this.count,
+    required this.sum,
+    required this.p50,
+    required this.p90,
+    required this.p99,
+    required this.max,
+  });
+
+  /// Summary of a sketch that has not recorded any values.
+  static const empty =
+      QuantileSummary(count: 0, sum: 0, p50: 0, p90: 0, p99: 0, max: 0);
+
+  @override
+  String toString() =>
+      'QuantileSummary(count: $count, p50: $p50, p90: $p90, p99: $p99, '
+      'max: $max)';
+}
+
+/// Mergeable quantile sketch with bounded relative error (DDSketch-style).
+///
+/// Values are mapped to logarithmic buckets `ceil(log_gamma(v))` where
+/// `gamma = (1 + a) / (1 - a)`, so every quantile estimate is within the
+/// relative accuracy `a` of the true value. The bucket array is allocated
+/// once for the configured `[minValue, maxValue]` range, which makes [add]
+/// O(1) and memory bounded. Values below `minValue` (including zero) are
+/// counted in a dedicated zero bucket; values above `maxValue` land in the
+/// top bucket.
+///
+/// Two sketches can be [merge]d when they share the same configuration.
+class QuantileSketch {
+  final double relativeAccuracy;
+  final double minValue;
+  final double maxValue;
+
+  final double _gamma;
+  final double _logGamma;
+  final int _minKey;
+
+  /// Per-bucket counts. 32-bit is plenty for windowed use.
+  final Uint32List _bins;
+
+  int _zeroCount = 0;
+  int _count = 0;
+  double _sum = 0;
+  double _min = double.infinity;
+  double _max = double.negativeInfinity;
+
+  /// Creates a sketch covering `[minValue, maxValue]` with the given
+  /// [relativeAccuracy] (e.g. 0.01 for 1%).
+  factory QuantileSketch({
+    double relativeAccuracy = 0.01,
+    double minValue = 1e-3,
+    double maxValue = 1e6,
+  }) {
+    if (relativeAccuracy <= 0 || relativeAccuracy >= 1) {
+      throw ArgumentError.value(
+          relativeAccuracy, 'relativeAccuracy', 'Must be in (0, 1)');
+    }
+    if (minValue <= 0 || maxValue <= minValue) {
+      throw ArgumentError('Requires 0 < minValue < maxValue');
+    }
+    final gamma = (1 + relativeAccuracy) / (1 - relativeAccuracy);
+    final logGamma = math.log(gamma);
+    final minKey = (math.log(minValue) / logGamma).ceil();
+    final maxKey = (math.log(maxValue) / logGamma).ceil();
+    return QuantileSketch._(relativeAccuracy, minValue, maxValue, gamma,
+        logGamma, minKey, Uint32List(maxKey - minKey + 1));
+  }
+
+  QuantileSketch._(this.relativeAccuracy, this.minValue, this.maxValue,
+      this._gamma, this._logGamma, this._minKey, this._bins);
+
+  /// Returns an empty sketch with the same configuration.
+  QuantileSketch emptyCopy() => QuantileSketch._(relativeAccuracy, minValue,
+      maxValue, _gamma, _logGamma, _minKey, Uint32List(_bins.length));
+
+  int get count => _count;
+  double get sum => _sum;
+  double get min => _count == 0 ? 0.0 : _min;
+  double get max => _count == 0 ? 0.0 : _max;
+
+  /// Records [value] with the given [weight]. NaN and non-positive weights
+  /// are ignored.
+  void add(double value, [int weight = 1]) {
+    if (weight <= 0 || value.isNaN) return;
+
+    if (value < minValue) {
+      _zeroCount += weight;
+    } else {
+      var index = (math.log(value) / _logGamma).ceil() - _minKey;
+      if (index >= _bins.length) index = _bins.length - 1;
+      if (index < 0) index = 0;
+      _bins[index] += weight;
+    }
+
+    _count += weight;
+    _sum += value * weight;
+    if (value < _min) _min = value;
+    if (value > _max) _max = value;
+  }
+
+  /// Adds all values recorded by [other] to this sketch.
+  ///
+  /// Throws [ArgumentError] if the sketches are configured differently.
+  void merge(QuantileSketch other) {
+    if (other.relativeAccuracy != relativeAccuracy ||
+        other.minValue != minValue ||
+        other.maxValue != maxValue) {
+      throw ArgumentError('Cannot merge sketches with different configuration');
+    }
+    if (other._count == 0) return;
+
+    for (var i = 0; i < _bins.length; i++) {
+      _bins[i] += other._bins[i];
+    }
+    _zeroCount += other._zeroCount;
+    _count += other._count;
+    _sum += other._sum;
+    if (other._min < _min) _min = other._min;
+    if (other._max > _max) _max = other._max;
+  }
+
+  /// Returns the estimated value at quantile [q] (0.0 - 1.0).
+  ///
+  /// Returns 0.0 if the sketch is empty.
+  double quantile(double q) {
+    if (_count == 0) return 0.0;
+    if (q <= 0) return _min;
+    if (q >= 1) return _max;
+
+    final rank = q * (_count - 1);
+    var seen = _zeroCount;
+    if (seen > rank) return _min;
+
+    for (var i = 0; i < _bins.length; i++) {
+      seen += _bins[i];
+      if (seen > rank) {
+        final estimate = 2 * math.pow(_gamma, i + _minKey) / (_gamma + 1);
+        return estimate.clamp(_min, _max).toDouble();
+      }
+    }
+    return _max;
+  }
+
+  QuantileSummary summary() {
+    if (_count == 0) return QuantileSummary.empty;
+    return QuantileSummary(
+      count: _count,
+      sum: _sum,
+      p50: quantile(0.5),
+      p90: quantile(0.9),
+      p99: quantile(0.99),
+      max: _max,
+    );
+  }
+
+  void clear() {
+    _bins.fillRange(0, _bins.length, 0);
+    _zeroCount = 0;
+    _count = 0;
+    _sum = 0;
+    _min = double.infinity;
+    _max = double.negativeInfinity;
+  }
+}
+
+/// Rolling-window quantile sketch built from a ring of sub-window sketches.
+///
+/// The window is split into `slots` equal time slots. Each insert goes to
+/// the slot owning its timestamp; a slot is cleared when it is reused for a
+/// newer time range. Queries merge the slots that are still inside the
+/// window into one reused scratch sketch, so memory stays bounded at
+/// `slots + 1` sketches, [summary] allocates no bins and inserts stay O(1)
+/// regardless of how irregularly they arrive.
+class WindowedQuantileSketch {
+  final Duration window;
+  final int _slotMicros;
+  final List<QuantileSketch> _slots;
+  final List<int> _slotEpochs;
+  final QuantileSketch _scratch;
+
+  WindowedQuantileSketch({
+    required this.window,
+    int slots = 6,
+    double relativeAccuracy = 0.01,
+    double minValue = 1e-3,
+    double maxValue = 1e6,
+  })  : assert(slots > 0),
+        _slotMicros = math.max(1, window.inMicroseconds ~/ slots),
+        _slots = List.generate(
+          slots,
+          (_) => QuantileSketch(
+            relativeAccuracy: relativeAccuracy,
+            minValue: minValue,
+            maxValue: maxValue,
+          ),
+        ),
+        _slotEpochs = List.filled(slots, -1),
+        _scratch = QuantileSketch(
+          relativeAccuracy: relativeAccuracy,
+          minValue: minValue,
+          maxValue: maxValue,
+        );
+
+  /// Records [value] at monotonic time [nowMicros].
+  void add(double value, int nowMicros, [int weight = 1]) {
+    final epoch = nowMicros ~/ _slotMicros;
+    final index = epoch % _slots.length;
+    if (_slotEpochs[index] != epoch) {
+      _slots[index].clear();
+      _slotEpochs[index] = epoch;
+    }
+    _slots[index].add(value, weight);
+  }
+
+  /// Returns a new sketch holding every value recorded within the window
+  /// ending at [nowMicros].
+  QuantileSketch merged(int nowMicros) {
+    final result = _slots.first.emptyCopy();
+    _mergeInto(result, nowMicros);
+    return result;
+  }
+
+  /// Summary of the values recorded within the window ending at
+  /// [nowMicros]. Unlike [merged], it reuses a scratch sketch.
+  QuantileSummary summary(int nowMicros) {
+    _scratch.clear();
+    _mergeInto(_scratch, nowMicros);
+    return _scratch.summary();
+  }
+
+  void _mergeInto(QuantileSketch result, int nowMicros) {
+    final current = nowMicros ~/ _slotMicros;
+    for (var i = 0; i < _slots.length; i++) {
+      final epoch = _slotEpochs[i];
+      if (epoch >= 0 && current - epoch < _slots.length) {
+        result.merge(_slots[i]);
+      }
+    }
+  }
+
+  void clear() {
+    for (var i = 0; i < _slots.length; i++) {
+      _slots[i].clear();
+      _slotEpochs[i] = -1;
+    }
+  }
+}
@@ -0,0 +1,376 @@
+import 'cpu_monitor.dart';
+import 'macos_native.dart';
+import 'memory_monitor.dart';
+import 'platform_detector.dart';
+import 'pressure_monitor.dart';
+
+/// Raw readings taken in one pass by [ResourceBackend.readAll].
+typedef ResourceReadings = ({
+  /// Cumulative CPU time in microseconds, or `null` if not exposed.
+  int? cpuUsageMicros,
+
+  /// Normalized load for backends without a cumulative CPU counter.
+  double? cpuLoad,
+  double cpuLimitCores,
+  int throttlePeriods,
+  int throttledPeriods,
+  int memoryUsedBytes,
+  int workingSetBytes,
+  int memoryLimitBytes,
+  int effectiveMemoryLimitBytes,
+  double cpuPressure,
+  double memoryPressure,
+});
+
+/// Metric source for one runtime environment.
+///
+/// A backend is selected once from [PlatformDetector.detectPlatform] and
+/// cached in [current], so metric getters make a single virtual call
+/// instead of re-detecting the platform and re-resolving readers on every
+/// call. [readAll] batches everything the sampler needs into one pass.
+abstract class ResourceBackend {
+  static ResourceBackend? _cached;
+
+  const ResourceBackend();
+
+  /// The backend for the detected platform, selected on first use.
+  static ResourceBackend get current => _cached ??= select();
+
+  /// Probes the environment and returns the cheapest suitable backend.
+  ///
+  /// Inside gVisor every `/proc` and `/sys` read is a round trip through
+  /// the Sentry, so the gVisor variants skip sources the sandbox does not
+  /// implement (PSI) and batch the rest.
+  static ResourceBackend select() {
+    final platform = PlatformDetector.detectPlatform();
+    if (platform == DetectedPlatform.macOS ||
+        platform == DetectedPlatform.unsupported ||
+        !PlatformDetector.isGVisor()) {
+      return forPlatform(platform);
+    }
+    return switch (platform) {
+      DetectedPlatform.linuxCgroupV2 => const CgroupBackend.v2(pressure: false),
+      DetectedPlatform.linuxCgroupV1 => const CgroupBackend.v1(pressure: false),
+      _ => GVisorBackend(),
+    };
+  }
+
+  static ResourceBackend forPlatform(DetectedPlatform platform) =>
+      switch (platform) {
+        DetectedPlatform.macOS => const MacOsBackend(),
+        DetectedPlatform.linuxCgroupV2 => const CgroupBackend.v2(),
+        DetectedPlatform.linuxCgroupV1 => const CgroupBackend.v1(),
+        DetectedPlatform.linuxHost => const ProcBackend(),
+        DetectedPlatform.unsupported => const UnsupportedBackend(),
+      };
+
+  DetectedPlatform get platform;
+
+  /// Load normalized by the CPU limit (see `SystemResources.cpuLoadAvg`).
+  double cpuLoadAvg();
+
+  /// Delta-based CPU load as a fraction of the limit, 0.0 if unsupported.
+  double cpuLoad() => 0.0;
+
+  /// Delta-based CPU usage in millicores, 0 if unsupported.
+  int cpuUsageMillicores() => 0;
+
+  /// Cumulative cgroup CPU time in microseconds, 0 if unsupported.
+  int cpuUsageMicros() => 0;
+
+  double cpuLimitCores() => PlatformDetector.cpuCount().toDouble();
+
+  int cpuLimitMillicores() => PlatformDetector.cpuCount() * 1000;
+
+  int memoryLimitBytes();
+
+  int memoryUsedBytes();
+
+  /// Reads every sampler input in one pass.
+  ResourceReadings readAll();
+
+  static void clearCache() {
+    _cached = null;
+  }
+}
+
+/// Linux with cgroup v1 or v2 accounting.
+class CgroupBackend extends ResourceBackend {
+  @override
+  final DetectedPlatform platform;
+
+  final int Function() _usageMicros;
+  final int Function() _limitMillicores;
+  final ({int periods, int throttled}) Function() _throttleStats;
+  final int Function() _usedBytes;
+  final int Function() _limitBytes;
+  final int Function() _workingSetBytes;
+  final int Function(int limitBytes) _effectiveLimitBytes;
+
+  /// Whether PSI files are read. Disabled where PSI is not implemented.
+  final bool pressure;
+
+  const CgroupBackend.v2({this.pressure = true})
+      : platform = DetectedPlatform.linuxCgroupV2,
+        _usageMicros = CpuMonitor.readV2UsageMicros,
+        _limitMillicores = CpuMonitor.readV2LimitMillicores,
+        _throttleStats = CpuMonitor.readV2ThrottleStats,
+        _usedBytes = MemoryMonitor.readV2UsedBytes,
+        _limitBytes = MemoryMonitor.readV2LimitBytes,
+        _workingSetBytes = MemoryMonitor.readV2WorkingSetBytes,
+        _effectiveLimitBytes = MemoryMonitor.readV2EffectiveLimitBytes;
+
+  const CgroupBackend.v1({this.pressure = true})
+      : platform = DetectedPlatform.linuxCgroupV1,
+        _usageMicros = CpuMonitor.readV1UsageMicros,
+        _limitMillicores = CpuMonitor.readV1LimitMillicores,
+        _throttleStats = CpuMonitor.readV1ThrottleStats,
+        _usedBytes = MemoryMonitor.readV1UsedBytes,
+        _limitBytes = MemoryMonitor.readV1LimitBytes,
+        _workingSetBytes = MemoryMonitor.readV1WorkingSetBytes,
+        _effectiveLimitBytes = _sameLimit;
+
+  /// cgroup v1 has no `memory.high`.
+  static int _sameLimit(int limitBytes) => limitBytes;
+
+  @override
+  double cpuLoadAvg() => CpuMonitor.getLoad(_usageMicros, _limitMillicores);
+
+  @override
+  double cpuLoad() => CpuMonitor.getLoad(_usageMicros, _limitMillicores);
+
+  @override
+  int cpuUsageMillicores() => CpuMonitor.getUsageMillicores(_usageMicros);
+
+  @override
+  int cpuUsageMicros() => _usageMicros();
+
+  @override
+  double cpuLimitCores() => CpuMonitor.getLimitCores(_limitMillicores);
+
+  @override
+  int cpuLimitMillicores() => _limitMillicores();
+
+  @override
+  int memoryLimitBytes() => _limitBytes();
+
+  @override
+  int memoryUsedBytes() => _usedBytes();
+
+  @override
+  ResourceReadings readAll() {
+    final throttle = _throttleStats();
+    final limit = _limitBytes();
+    return (
+      cpuUsageMicros: _usageMicros(),
+      cpuLoad: null,
+      cpuLimitCores: cpuLimitCores(),
+      throttlePeriods: throttle.periods,
+      throttledPeriods: throttle.throttled,
+      memoryUsedBytes: _usedBytes(),
+      workingSetBytes: _workingSetBytes(),
+      memoryLimitBytes: limit,
+      effectiveMemoryLimitBytes: _effectiveLimitBytes(limit),
+      cpuPressure: pressure ? PressureMonitor.readCpuSomeAvg10() : 0.0,
+      memoryPressure: pressure ? PressureMonitor.readMemorySomeAvg10() : 0.0,
+    );
+  }
+}
+
+/// Linux without cgroups: `/proc/loadavg`, `/proc/stat`, `/proc/meminfo`.
+class ProcBackend extends ResourceBackend {
+  const ProcBackend();
+
+  @override
+  DetectedPlatform get platform => DetectedPlatform.linuxHost;
+
+  @override
+  double cpuLoadAvg() => CpuMonitor.readProcLoadAvg();
+
+  @override
+  int memoryLimitBytes() => MemoryMonitor.readProcMemTotal();
+
+  @override
+  int memoryUsedBytes() => MemoryMonitor.readProcMemUsed();
+
+  @override
+  ResourceReadings readAll() {
+    final memory = MemoryMonitor.readProcMemInfo();
+    return (
+      cpuUsageMicros: CpuMonitor.readProcStatUsageMicros(),
+      cpuLoad: null,
+      cpuLimitCores: cpuLimitCores(),
+      throttlePeriods: 0,
+      throttledPeriods: 0,
+      memoryUsedBytes: memory.used,
+      workingSetBytes: memory.used,
+      memoryLimitBytes: memory.total,
+      effectiveMemoryLimitBytes: memory.total,
+      cpuPressure: PressureMonitor.readCpuSomeAvg10(),
+      memoryPressure: PressureMonitor.readMemorySomeAvg10(),
+    );
+  }
+}
+
+/// gVisor without cgroupfs.
+///
+/// `/proc/loadavg` is not virtualized by gVisor, so CPU load is derived
+/// from the sandbox-wide `/proc/stat` counters instead. Limits come from
+/// the downward API files when present (read once, when the backend is
+/// selected), then `SYSRES_CPU_CORES`, then the virtualized
+/// `/proc/meminfo` and CPU count. A tick costs two Sentry reads:
+/// `/proc/stat` and `/proc/meminfo`.
+class GVisorBackend extends ResourceBackend {
+  final int _limitMillicores = CpuMonitor.readDownwardLimitMillicores();
+  final int _limitBytes = MemoryMonitor.readDownwardLimitBytes();
+
+  GVisorBackend();
+
+  @override
+  DetectedPlatform get platform => DetectedPlatform.linuxHost;
+
+  int _readLimitMillicores() => _limitMillicores;
+
+  @override
+  double cpuLoadAvg() => cpuLoad();
+
+  @override
+  double cpuLoad() => CpuMonitor.getLoad(
+      CpuMonitor.readProcStatUsageMicros, _readLimitMillicores);
+
+  @override
+  int cpuUsageMillicores() =>
+      CpuMonitor.getUsageMillicores(CpuMonitor.readProcStatUsageMicros);
+
+  @override
+  int cpuUsageMicros() => CpuMonitor.readProcStatUsageMicros();
+
+  @override
+  double cpuLimitCores() => CpuMonitor.getLimitCores(_readLimitMillicores);
+
+  @override
+  int cpuLimitMillicores() =>
+      _limitMillicores > 0 ? _limitMillicores : super.cpuLimitMillicores();
+
+  @override
+  int memoryLimitBytes() =>
+      _limitBytes > 0 ? _limitBytes : MemoryMonitor.readProcMemTotal();
+
+  @override
+  int memoryUsedBytes() => MemoryMonitor.readProcMemUsed();
+
+  @override
+  ResourceReadings readAll() {
+    final memory = MemoryMonitor.readProcMemInfo();
+    final limit = _limitBytes > 0 ? _limitBytes : memory.total;
+    return (
+      cpuUsageMicros: CpuMonitor.readProcStatUsageMicros(),
+      cpuLoad: null,
+      cpuLimitCores: cpuLimitCores(),
+      throttlePeriods: 0,
+      throttledPeriods: 0,
+      memoryUsedBytes: memory.used,
+      workingSetBytes: memory.used,
+      memoryLimitBytes: limit,
+      effectiveMemoryLimitBytes: limit,
+      cpuPressure: 0.0,
+      memoryPressure: 0.0,
+    );
+  }
+}
+
+/// macOS through the native library. Getters require
+/// `SystemResources.init()`; [readAll] reports zeros until then.
+class MacOsBackend extends ResourceBackend {
+  const MacOsBackend();
+
+  @override
+  DetectedPlatform get platform => DetectedPlatform.macOS;
+
+  /// Throws if init() wasn't called.
+  static void _ensureInit() {
+    if (!MacOsNative.isInitialized) {
+      throw StateError(
+        'SystemResources not initialized. Call SystemResources.init() first.',
+      );
+    }
+  }
+
+  @override
+  double cpuLoadAvg() {
+    _ensureInit();
+    return MacOsNative.cpuLoadAvg();
+  }
+
+  @override
+  double cpuLimitCores() {
+    _ensureInit();
+    return MacOsNative.cpuLimitCores();
+  }
+
+  @override
+  int memoryLimitBytes() {
+    _ensureInit();
+    return MacOsNative.memoryLimitBytes();
+  }
+
+  @override
+  int memoryUsedBytes() {
+    _ensureInit();
+    return MacOsNative.memoryUsedBytes();
+  }
+
+  @override
+  ResourceReadings readAll() {
+    final ready = MacOsNative.isInitialized;
+    final used = ready ? MacOsNative.memoryUsedBytes() : 0;
+    final limit = ready ? MacOsNative.memoryLimitBytes() : 0;
+    return (
+      cpuUsageMicros: null,
+      cpuLoad: ready ? MacOsNative.cpuLoadAvg() : 0.0,
+      cpuLimitCores: ready
+          ? MacOsNative.cpuLimitCores()
+          : PlatformDetector.cpuCount().toDouble(),
+      throttlePeriods: 0,
+      throttledPeriods: 0,
+      memoryUsedBytes: used,
+      workingSetBytes: used,
+      memoryLimitBytes: limit,
+      effectiveMemoryLimitBytes: limit,
+      cpuPressure: 0.0,
+      memoryPressure: 0.0,
+    );
+  }
+}
+
+/// Unsupported OS: all metrics are zero.
+class UnsupportedBackend extends ResourceBackend {
+  const UnsupportedBackend();
+
+  @override
+  DetectedPlatform get platform => DetectedPlatform.unsupported;
+
+  @override
+  double cpuLoadAvg() => 0.0;
+
+  @override
+  int memoryLimitBytes() => 0;
+
+  @override
+  int memoryUsedBytes() => 0;
+
+  @override
+  ResourceReadings readAll() => (
+        cpuUsageMicros: null,
+        cpuLoad: null,
+        cpuLimitCores: cpuLimitCores(),
+        throttlePeriods: 0,
+        throttledPeriods: 0,
+        memoryUsedBytes: 0,
+        workingSetBytes: 0,
+        memoryLimitBytes: 0,
+        effectiveMemoryLimitBytes: 0,
+        cpuPressure: 0.0,
+        memoryPressure: 0.0,
+      );
+}
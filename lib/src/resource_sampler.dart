@@ -0,0 +1,460 @@
+import 'dart:async';
+
+import 'cpu_frequency.dart';
+import 'fd_monitor.dart';
+import 'memory_events.dart';
+import 'memory_peak.dart';
+import 'network_monitor.dart';
+import 'process_tree.dart';
+import 'quantile_sketch.dart';
+import 'resource_backend.dart';
+import 'self_stats.dart';
+import 'threshold_watcher.dart';
+
+/// A point-in-time view of resource usage produced by [ResourceSampler].
+///
+/// Per-tick values describe the interval since the previous sample. The
+/// quantile summaries cover the sampler's rolling window.
+class ResourceSnapshot {
+  /// Monotonic timestamp of the sample in microseconds.
+  final int timestampMicros;
+
+  /// Actual time since the previous sample in microseconds (0 for the
+  /// first sample).
+  final int elapsedMicros;
+
+  /// Sampling interval that was in effect for this sample. Varies between
+  /// the configured bounds when adaptive sampling is enabled.
+  final Duration samplingInterval;
+
+  /// CPU usage as a fraction of the CPU limit over the last tick.
+  /// Can exceed 1.0 when usage exceeds the limit.
+  final double cpuUtilization;
+
+  /// CPU usage in millicores over the last tick.
+  final int cpuUsageMillicores;
+
+  /// CPU limit in cores (container limit or host cores).
+  final double cpuLimitCores;
+
+  /// Fraction of CFS periods that were throttled over the last tick.
+  final double throttledRatio;
+
+  final int memoryUsedBytes;
+
+  /// Memory usage minus reclaimable inactive file cache.
+  final int workingSetBytes;
+
+  /// Highest memory usage since the previous snapshot, including spikes
+  /// between ticks where `memory.peak` can be reset (Linux 6.12+, see
+  /// [MemoryPeakMonitor]). At least [memoryUsedBytes].
+  final int memoryPeakBytes;
+
+  /// Page events per second since the previous snapshot, from cgroup v2
+  /// `memory.stat` or host-wide `/proc/vmstat` (see [MemoryEventRates]):
+  /// faults, LRU activations and deactivations, active list refills, and
+  /// pages scanned and reclaimed.
+  final double pageFaultsPerSecond;
+  final double pageActivationsPerSecond;
+  final double pageDeactivationsPerSecond;
+  final double pageRefillsPerSecond;
+  final double pageScansPerSecond;
+  final double pageStealsPerSecond;
+
+  /// Pages reclaimed per page scanned; 1.0 when nothing was scanned.
+  final double reclaimEfficiency;
+
+  final int memoryLimitBytes;
+
+  /// Memory limit at which the kernel starts reclaiming or throttling
+  /// (`memory.high` when lower than `memory.max`). 0 means same as
+  /// [memoryLimitBytes].
+  final int effectiveMemoryLimitBytes;
+
+  /// PSI `some avg10` for CPU as a fraction (0.0 if unavailable).
+  final double cpuPressure;
+
+  /// PSI `some avg10` for memory as a fraction (0.0 if unavailable).
+  final double memoryPressure;
+
+  /// Current / maximum clock of the allowed CPUs (see
+  /// [CpuFrequency.capacityFactor]). 1.0 when cpufreq is not exposed.
+  final double cpuCapacityFactor;
+
+  /// Thermal throttle events since the previous tick (0 if unavailable).
+  final int thermalThrottleEvents;
+
+  /// Bytes per second received and sent on non-loopback interfaces of the
+  /// network namespace (see [NetworkStats]).
+  final double networkReceiveBytesPerSecond;
+  final double networkTransmitBytesPerSecond;
+
+  /// TCP segments retransmitted per second.
+  final double tcpRetransmitsPerSecond;
+
+  /// TCP buffer pages relative to the `tcp_mem` pressure threshold (see
+  /// [NetworkStats.tcpMemoryPressure]).
+  final double tcpMemoryPressure;
+
+  /// Open file descriptors and the soft `RLIMIT_NOFILE` (-1 unlimited, 0
+  /// unknown). Refreshed every [FdMonitor.sampleInterval], not every tick.
+  final int openFileDescriptors;
+  final int fileDescriptorLimit;
+
+  /// CPU used and resident memory of this process and its descendants,
+  /// including reaped children (see [ProcessTreeUsage]). 0 unless the
+  /// sampler was started with `processTree: true`.
+  final int processTreeCpuMillicores;
+  final int processTreeRssBytes;
+
+  /// Live processes in the tree; 0 when process-tree mode is off.
+  final int processTreeProcesses;
+
+  final QuantileSummary cpuUtilizationQuantiles;
+  final QuantileSummary throttledRatioQuantiles;
+  final QuantileSummary workingSetQuantiles;
+
+  /// What sampling has cost so far, including this tick.
+  final MonitoringOverhead overhead;
+
+  const ResourceSnapshot({
+    required this.timestampMicros,
+    this.elapsedMicros = 0,
+    this.samplingInterval = Duration.zero,
+    required this.cpuUtilization,
+    required this.cpuUsageMillicores,
+    required this.cpuLimitCores,
+    required this.throttledRatio,
+    required this.memoryUsedBytes,
+    required this.workingSetBytes,
+    this.memoryPeakBytes = 0,
+    this.pageFaultsPerSecond = 0.0,
+    this.pageActivationsPerSecond = 0.0,
+    this.pageDeactivationsPerSecond = 0.0,
+    this.pageRefillsPerSecond = 0.0,
+    this.pageScansPerSecond = 0.0,
+    this.pageStealsPerSecond = 0.0,
+    this.reclaimEfficiency = 1.0,
+    required this.memoryLimitBytes,
+    this.effectiveMemoryLimitBytes = 0,
+    this.cpuPressure = 0.0,
+    this.memoryPressure = 0.0,
+    this.cpuCapacityFactor = 1.0,
+    this.thermalThrottleEvents = 0,
+    this.networkReceiveBytesPerSecond = 0.0,
+    this.networkTransmitBytesPerSecond = 0.0,
+    this.tcpRetransmitsPerSecond = 0.0,
+    this.tcpMemoryPressure = 0.0,
+    this.openFileDescriptors = 0,
+    this.fileDescriptorLimit = 0,
+    this.processTreeCpuMillicores = 0,
+    this.processTreeRssBytes = 0,
+    this.processTreeProcesses = 0,
+    required this.cpuUtilizationQuantiles,
+    required this.throttledRatioQuantiles,
+    required this.workingSetQuantiles,
+    this.overhead = MonitoringOverhead.empty,
+  });
+}
+
+/// Periodic sampler that keeps rolling-window distributions of CPU
+/// utilization, CFS throttling and memory working set.
+///
+/// Every tick also advances the registered [ThresholdWatcher] rules, so
+/// threshold transitions are pushed to listeners instead of polled.
+///
+/// With adaptive sampling enabled, the interval halves (down to the
+/// minimum) while metrics change quickly, approach a threshold rule or show
+/// pressure, and doubles (up to the maximum) while utilization is low and
+/// stable. Window distributions are weighted by the time each sample
+/// covers, so they stay correct under variable tick spacing.
+///
+/// The sampler keeps its own delta state for CPU usage and for the
+/// network, memory event and process tree rates, so it does not interfere
+/// with the call-to-call deltas of `SystemResources.cpuLoad()`,
+/// `networkStats()`, `memoryEvents()` or `processTreeUsage()`.
+class ResourceSampler {
+  static final Stopwatch _clock = Stopwatch()..start();
+
+  /// Utilization or pressure above which the sampler speeds up.
+  static const _hotUtilization = 0.8;
+  static const _hotPressure = 0.05;
+
+  /// Tick-to-tick change (fraction of the limit) treated as fast.
+  static const _fastCpuChange = 0.1;
+  static const _fastMemoryChange = 0.05;
+
+  /// Utilization below which a stable sampler slows down.
+  static const _calmUtilization = 0.5;
+
+  static Timer? _timer;
+  static final StreamController<ResourceSnapshot> _snapshots =
+      StreamController<ResourceSnapshot>.broadcast();
+  static Duration _window = const Duration(minutes: 1);
+  static Duration _interval = const Duration(seconds: 1);
+  static Duration? _minInterval;
+  static Duration? _maxInterval;
+  static bool _processTree = false;
+  static ResourceSnapshot? _latest;
+
+  static WindowedQuantileSketch? _cpuSketch;
+  static WindowedQuantileSketch? _throttleSketch;
+  static WindowedQuantileSketch? _workingSetSketch;
+
+  static int? _previousTickMicros;
+  static int? _previousUsageMicros;
+  static int? _previousPeriods;
+  static int? _previousThrottled;
+  static int? _previousThermalThrottles;
+
+  /// Returns `true` while the sampler is scheduled.
+  static bool get isRunning => _timer != null;
+
+  /// The most recent snapshot, or `null` if nothing was sampled yet.
+  static ResourceSnapshot? get latest => _latest;
+
+  /// Broadcast stream of every snapshot taken by the sampler.
+  static Stream<ResourceSnapshot> get snapshots => _snapshots.stream;
+
+  /// The interval until the next scheduled sample.
+  static Duration get interval => _interval;
+
+  /// Current monotonic time in microseconds, as used for snapshots.
+  static int nowMicros() => _clock.elapsedMicroseconds;
+
+  /// Starts sampling every [interval], keeping distributions over [window].
+  ///
+  /// When [minInterval] and [maxInterval] are given, the interval adapts
+  /// between them, starting from [interval] (clamped to the bounds).
+  /// With [processTree], snapshots include usage summed over descendant
+  /// processes. Restarts the sampler if it is already running.
+  static void start({
+    Duration interval = const Duration(seconds: 1),
+    Duration window = const Duration(minutes: 1),
+    Duration? minInterval,
+    Duration? maxInterval,
+    Duration fdInterval = const Duration(seconds: 10),
+    bool processTree = false,
+  }) {
+    if ((minInterval == null) != (maxInterval == null)) {
+      throw ArgumentError('minInterval and maxInterval must be set together');
+    }
+    if (minInterval != null &&
+        maxInterval != null &&
+        (minInterval <= Duration.zero || maxInterval < minInterval)) {
+      throw ArgumentError('Requires 0 < minInterval <= maxInterval');
+    }
+    if (interval <= Duration.zero) {
+      throw ArgumentError.value(interval, 'interval', 'Must be positive');
+    }
+    if (fdInterval <= Duration.zero) {
+      throw ArgumentError.value(fdInterval, 'fdInterval', 'Must be positive');
+    }
+    FdMonitor.sampleInterval = fdInterval;
+    _processTree = processTree;
+
+    stop();
+    if (window != _window) {
+      _window = window;
+      _cpuSketch = null;
+      _throttleSketch = null;
+      _workingSetSketch = null;
+    }
+    _minInterval = minInterval;
+    _maxInterval = maxInterval;
+    _interval = _clamp(interval);
+
+    sample();
+    _schedule();
+  }
+
+  /// Stops the sampler. Collected distributions are kept.
+  static void stop() {
+    _timer?.cancel();
+    _timer = null;
+  }
+
+  static void _schedule() {
+    late final Timer timer;
+    timer = Timer(_interval, () {
+      sample();
+      // Reschedule unless stopped or restarted during the sample.
+      if (identical(_timer, timer)) _schedule();
+    });
+    _timer = timer;
+  }
+
+  /// Takes one sample immediately and returns the resulting snapshot.
+  static ResourceSnapshot sample() {
+    SelfStats.beginSample();
+    final cpuSketch = _cpuSketch ??=
+        WindowedQuantileSketch(window: _window, minValue: 1e-4, maxValue: 1e3);
+    final throttleSketch = _throttleSketch ??=
+        WindowedQuantileSketch(window: _window, minValue: 1e-4, maxValue: 1.0);
+    final workingSetSketch = _workingSetSketch ??= WindowedQuantileSketch(
+        window: _window, minValue: 1024, maxValue: 1.0 * (1 << 50));
+
+    final now = nowMicros();
+    final previousTick = _previousTickMicros;
+    final elapsed = previousTick == null ? 0 : now - previousTick;
+
+    final readings = ResourceBackend.current.readAll();
+    final limitCores = readings.cpuLimitCores;
+    final usageMicros = readings.cpuUsageMicros;
+
+    var millicores = 0;
+    var utilization = 0.0;
+    var throttledRatio = 0.0;
+    if (elapsed > 0) {
+      if (usageMicros != null && _previousUsageMicros != null) {
+        final delta = usageMicros - _previousUsageMicros!;
+        millicores = delta <= 0 ? 0 : (delta * 1000) ~/ elapsed;
+        utilization = limitCores > 0 ? millicores / (limitCores * 1000) : 0.0;
+      }
+      final periods = readings.throttlePeriods - (_previousPeriods ?? 0);
+      final throttled = readings.throttledPeriods - (_previousThrottled ?? 0);
+      if (periods > 0 && throttled >= 0) {
+        throttledRatio = throttled / periods;
+      }
+    }
+    final load = readings.cpuLoad;
+    if (usageMicros == null && load != null) {
+      // No cumulative CPU counter is exposed; use the normalized load.
+      utilization = load;
+      millicores = (utilization * limitCores * 1000).round();
+    }
+
+    final workingSet = readings.workingSetBytes;
+    final memoryPeak = MemoryPeakMonitor.sample(readings.memoryUsedBytes);
+    final memoryEvents = MemoryEventMonitor.sample();
+    final frequency = CpuFrequencyMonitor.read();
+    final thermalThrottles = frequency.thermalThrottleCount;
+    final previousThrottles = _previousThermalThrottles;
+    final thermalEvents =
+        previousThrottles == null || thermalThrottles < previousThrottles
+            ? 0
+            : thermalThrottles - previousThrottles;
+    final network = NetworkMonitor.sample();
+    final fds = FdMonitor.sample();
+    final tree =
+        _processTree ? ProcessTreeMonitor.sample() : ProcessTreeUsage.empty;
+
+    // Weight by the milliseconds each sample covers, so quantiles are
+    // time-weighted regardless of tick spacing.
+    final weight = elapsed >= 2000 ? elapsed ~/ 1000 : 1;
+    if (previousTick != null) {
+      cpuSketch.add(utilization, now, weight);
+      throttleSketch.add(throttledRatio, now, weight);
+    }
+    workingSetSketch.add(workingSet.toDouble(), now, weight);
+
+    _previousTickMicros = now;
+    _previousUsageMicros = usageMicros;
+    _previousPeriods = readings.throttlePeriods;
+    _previousThrottled = readings.throttledPeriods;
+    _previousThermalThrottles = thermalThrottles;
+
+    final overhead = SelfStats.endSample();
+    final previous = _latest;
+    final snapshot = _latest = ResourceSnapshot(
+      timestampMicros: now,
+      elapsedMicros: elapsed,
+      samplingInterval: _interval,
+      cpuUtilization: utilization,
+      cpuUsageMillicores: millicores,
+      cpuLimitCores: limitCores,
+      throttledRatio: throttledRatio,
+      memoryUsedBytes: readings.memoryUsedBytes,
+      workingSetBytes: workingSet,
+      memoryPeakBytes: memoryPeak,
+      pageFaultsPerSecond: memoryEvents.faultsPerSecond,
+      pageActivationsPerSecond: memoryEvents.activationsPerSecond,
+      pageDeactivationsPerSecond: memoryEvents.deactivationsPerSecond,
+      pageRefillsPerSecond: memoryEvents.refillsPerSecond,
+      pageScansPerSecond: memoryEvents.scansPerSecond,
+      pageStealsPerSecond: memoryEvents.stealsPerSecond,
+      reclaimEfficiency: memoryEvents.reclaimEfficiency,
+      memoryLimitBytes: readings.memoryLimitBytes,
+      effectiveMemoryLimitBytes: readings.effectiveMemoryLimitBytes,
+      cpuPressure: readings.cpuPressure,
+      memoryPressure: readings.memoryPressure,
+      cpuCapacityFactor: frequency.capacityFactor,
+      thermalThrottleEvents: thermalEvents,
+      networkReceiveBytesPerSecond: network.receiveBytesPerSecond,
+      networkTransmitBytesPerSecond: network.transmitBytesPerSecond,
+      tcpRetransmitsPerSecond: network.tcpRetransmitsPerSecond,
+      tcpMemoryPressure: network.tcpMemoryPressure,
+      openFileDescriptors: fds.open,
+      fileDescriptorLimit: fds.softLimit,
+      processTreeCpuMillicores: tree.cpuMillicores,
+      processTreeRssBytes: tree.rssBytes,
+      processTreeProcesses: tree.processes,
+      cpuUtilizationQuantiles: cpuSketch.summary(now),
+      throttledRatioQuantiles: throttleSketch.summary(now),
+      workingSetQuantiles: workingSetSketch.summary(now),
+      overhead: overhead,
+    );
+    ThresholdWatcher.evaluate(snapshot);
+    _interval = _adapt(snapshot, previous);
+    if (_snapshots.hasListener) _snapshots.add(snapshot);
+    return snapshot;
+  }
+
+  /// Returns the interval for the next tick. Changes are bounded to a
+  /// factor of two per tick and to the configured range.
+  static Duration _adapt(ResourceSnapshot current, ResourceSnapshot? previous) {
+    if (_minInterval == null || _maxInterval == null) return _interval;
+
+    final memoryRatio = _memoryRatio(current);
+    final changing = previous != null &&
+        ((current.cpuUtilization - previous.cpuUtilization).abs() >
+                _fastCpuChange ||
+            (memoryRatio - _memoryRatio(previous)).abs() > _fastMemoryChange);
+    final hot = changing ||
+        current.cpuUtilization > _hotUtilization ||
+        memoryRatio > _hotUtilization ||
+        current.cpuPressure > _hotPressure ||
+        current.memoryPressure > _hotPressure ||
+        ThresholdWatcher.isNear(current);
+    if (hot) return _clamp(_interval ~/ 2);
+
+    final calm = current.cpuUtilization < _calmUtilization &&
+        current.throttledRatio == 0 &&
+        current.cpuPressure == 0 &&
+        current.memoryPressure == 0;
+    if (calm) return _clamp(_interval * 2);
+
+    return _interval;
+  }
+
+  static double _memoryRatio(ResourceSnapshot snapshot) =>
+      snapshot.memoryLimitBytes > 0
+          ? snapshot.workingSetBytes / snapshot.memoryLimitBytes
+          : 0.0;
+
+  static Duration _clamp(Duration interval) {
+    final min = _minInterval;
+    final max = _maxInterval;
+    if (min != null && interval < min) return min;
+    if (max != null && interval > max) return max;
+    return interval;
+  }
+
+  /// Stops the sampler and drops all collected state. Useful for testing.
+  static void clearState() {
+    stop();
+    _interval = const Duration(seconds: 1);
+    _minInterval = null;
+    _maxInterval = null;
+    _processTree = false;
+    _latest = null;
+    _cpuSketch = null;
+    _throttleSketch = null;
+    _workingSetSketch = null;
+    _previousTickMicros = null;
+    _previousUsageMicros = null;
+    _previousPeriods = null;
+    _previousThrottled = null;
+    _previousThermalThrottles = null;
+  }
+}
@@ -0,0 +1,334 @@
+import 'dart:convert';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'macos_native.dart';
+import 'platform_detector.dart';
+
+/// Cumulative read counters for one metric source, e.g.
+/// `cgroup/memory.current` or `proc/meminfo`.
+class SourceStats {
+  /// Reads attempted.
+  final int reads;
+
+  /// Reads that failed (missing, unreadable or unparsable source).
+  final int failures;
+
+  /// Reads made because a preferred source was unusable, e.g.
+  /// `proc/meminfo` when `memory.max` is `max`.
+  final int fallbacks;
+
+  /// Bytes read.
+  final int bytes;
+
+  /// System calls issued by the reads (open, each read, close).
+  final int syscalls;
+
+  const SourceStats({
+    this.reads = 0,
+    this.failures = 0,
+    this.fallbacks = 0,
+    this.bytes = 0,
+    this.syscalls = 0,
+  });
+}
+
+/// What monitoring itself costs: per sampler tick and per source.
+///
+/// Tick figures cover the sampler ticks since the state was last cleared;
+/// [sources] also counts reads made by the metric getters.
+class MonitoringOverhead {
+  /// Sampler ticks measured.
+  final int samples;
+
+  /// Fastest, mean and slowest tick, in microseconds.
+  final int minSampleMicros;
+  final double avgSampleMicros;
+  final int maxSampleMicros;
+
+  /// Mean source reads, system calls and bytes read per tick.
+  final double readsPerSample;
+  final double syscallsPerSample;
+  final double bytesPerSample;
+
+  /// Mean time per tick not spent reading sources: parsing, deltas and
+  /// sketch updates, in microseconds.
+  final double parseMicrosPerSample;
+
+  /// Counters per source. On macOS, native library sources are included
+  /// with a `native/` prefix.
+  final Map<String, SourceStats> sources;
+
+  const MonitoringOverhead({
+    this.samples = 0,
+    this.minSampleMicros = 0,
+    this.avgSampleMicros = 0.0,
+    this.maxSampleMicros = 0,
+    this.readsPerSample = 0.0,
+    this.syscallsPerSample = 0.0,
+    this.bytesPerSample = 0.0,
+    this.parseMicrosPerSample = 0.0,
+    this.sources = const {},
+  });
+
+  static const empty = MonitoringOverhead();
+}
+
+class _SourceCounters {
+  int reads = 0;
+  int failures = 0;
+  int fallbacks = 0;
+  int bytes = 0;
+  int syscalls = 0;
+}
+
+/// Self-instrumentation: records the overhead of every source read and
+/// sampler tick so the cost of a sampling configuration is measured.
+///
+/// Sources are named by [sourceName], which folds per-process, per-CPU
+/// and per-node paths into one source each, and at most [maxSources] are
+/// tracked, so the counters (and the series exported from them) stay
+/// bounded in a long-running process.
+class SelfStats {
+  static const _chunkSize = 4096;
+
+  /// Most sources counted separately. Reads of further sources are
+  /// counted under [overflowSource].
+  static const maxSources = 128;
+  static const overflowSource = 'other';
+
+  /// Paths whose source name is cached; the cache is dropped when full.
+  static const _maxNames = 1024;
+
+  /// A path component that is a number, optionally after one of the
+  /// sysfs prefixes: pids and tids, `cpu3`, `node1`, `index2`, `policy0`.
+  static final _numbered = RegExp(r'^(cpu|node|index|policy)?\d+$');
+
+  static final Stopwatch _clock = Stopwatch()..start();
+  static final Map<String, _SourceCounters> _sources = {};
+  static final Map<String, String> _names = {};
+
+  // Totals over all reads.
+  static int _reads = 0;
+  static int _syscalls = 0;
+  static int _bytes = 0;
+  static int _readMicros = 0;
+
+  // Totals over sampler ticks.
+  static int _samples = 0;
+  static int _sampleMicros = 0;
+  static int _minSampleMicros = 0;
+  static int _maxSampleMicros = 0;
+  static int _sampleReads = 0;
+  static int _sampleSyscalls = 0;
+  static int _sampleBytes = 0;
+  static int _sampleReadMicros = 0;
+
+  static ({int micros, int reads, int syscalls, int bytes, int readMicros})?
+      _tick;
+
+  /// Reads the file at [path] as a string and counts the read against its
+  /// source: [source] if given, else [sourceName] of [path].
+  ///
+  /// Reads to EOF through a [RandomAccessFile], so the system calls are
+  /// known: open, one read per chunk plus the one that hits EOF, close.
+  /// Throws like [File.readAsStringSync] if the file cannot be read.
+  static String readFile(String path, {String? source}) {
+    final counters = _counters(source ?? sourceName(path));
+    final start = _clock.elapsedMicroseconds;
+    var syscalls = 1;
+    var length = 0;
+    try {
+      final file = File(path).openSync();
+      try {
+        final builder = BytesBuilder(copy: false);
+        while (true) {
+          syscalls++;
+          final chunk = file.readSync(_chunkSize);
+          if (chunk.isEmpty) break;
+          builder.add(chunk);
+        }
+        length = builder.length;
+        return utf8.decode(builder.takeBytes());
+      } finally {
+        syscalls++;
+        file.closeSync();
+      }
+    } catch (_) {
+      counters.failures++;
+      rethrow;
+    } finally {
+      _record(counters, syscalls, length, start);
+    }
+  }
+
+  /// Counts a read of [path] made without [readFile] (e.g. a stat or a
+  /// directory listing) that issued [syscalls] and started at
+  /// [startMicros] on [nowMicros]'s clock. Counted against [source] if
+  /// given, else [sourceName] of [path].
+  static void count(String path,
+      {required int syscalls,
+      required int startMicros,
+      int bytes = 0,
+      bool failed = false,
+      String? source}) {
+    final counters = _counters(source ?? sourceName(path));
+    if (failed) counters.failures++;
+    _record(counters, syscalls, bytes, startMicros);
+  }
+
+  /// The clock [count] expects start times on.
+  static int nowMicros() => _clock.elapsedMicroseconds;
+
+  static void _record(
+      _SourceCounters counters, int syscalls, int bytes, int startMicros) {
+    counters
+      ..reads += 1
+      ..syscalls += syscalls
+      ..bytes += bytes;
+    _reads++;
+    _syscalls += syscalls;
+    _bytes += bytes;
+    _readMicros += _clock.elapsedMicroseconds - startMicros;
+  }
+
+  /// Counts the next read of [path] as a fallback from a preferred source.
+  static void fallback(String path) =>
+      _counters(sourceName(path)).fallbacks++;
+
+  /// Counts a read of [path] whose contents could not be parsed as failed,
+  /// like the native `sysres_parse_failed`. Counted against [source] if
+  /// given, else [sourceName] of [path].
+  static void parseFailed(String path, {String? source}) =>
+      _counters(source ?? sourceName(path)).failures++;
+
+  /// Parses [text] read from [path] as an integer, or returns `null` and
+  /// counts the read as failed (see [parseFailed]) if it is not one.
+  static int? parseInt(String text, String path, {String? source}) {
+    final value = int.tryParse(text);
+    if (value == null) parseFailed(path, source: source);
+    return value;
+  }
+
+  /// Marks the start of a sampler tick.
+  static void beginSample() {
+    final native = MacOsNative.readStats();
+    _tick = (
+      micros: _clock.elapsedMicroseconds,
+      reads: _reads + (native?.reads ?? 0),
+      syscalls: _syscalls + (native?.syscalls ?? 0),
+      bytes: _bytes,
+      readMicros: _readMicros + (native?.ioMicros ?? 0),
+    );
+  }
+
+  /// Marks the end of the tick started by [beginSample] and returns the
+  /// overhead including it.
+  static MonitoringOverhead endSample() {
+    final tick = _tick;
+    if (tick == null) return current();
+    _tick = null;
+
+    final native = MacOsNative.readStats();
+    final micros = _clock.elapsedMicroseconds - tick.micros;
+    _samples++;
+    _sampleMicros += micros;
+    if (_samples == 1 || micros < _minSampleMicros) _minSampleMicros = micros;
+    if (micros > _maxSampleMicros) _maxSampleMicros = micros;
+    _sampleReads += _reads + (native?.reads ?? 0) - tick.reads;
+    _sampleSyscalls += _syscalls + (native?.syscalls ?? 0) - tick.syscalls;
+    _sampleBytes += _bytes - tick.bytes;
+    _sampleReadMicros +=
+        _readMicros + (native?.ioMicros ?? 0) - tick.readMicros;
+    return current();
+  }
+
+  /// Overhead recorded so far.
+  static MonitoringOverhead current() {
+    final native = MacOsNative.readStats();
+    final sources = <String, SourceStats>{
+      for (final MapEntry(key: name, value: counters) in _sources.entries)
+        name: SourceStats(
+          reads: counters.reads,
+          failures: counters.failures,
+          fallbacks: counters.fallbacks,
+          bytes: counters.bytes,
+          syscalls: counters.syscalls,
+        ),
+      if (native != null)
+        for (final MapEntry(key: name, value: stats)
+            in native.sources.entries)
+          'native/$name': stats,
+    };
+    if (_samples == 0) return MonitoringOverhead(sources: sources);
+
+    return MonitoringOverhead(
+      samples: _samples,
+      minSampleMicros: _minSampleMicros,
+      avgSampleMicros: _sampleMicros / _samples,
+      maxSampleMicros: _maxSampleMicros,
+      readsPerSample: _sampleReads / _samples,
+      syscallsPerSample: _sampleSyscalls / _samples,
+      bytesPerSample: _sampleBytes / _samples,
+      parseMicrosPerSample: (_sampleMicros - _sampleReadMicros) / _samples,
+      sources: sources,
+    );
+  }
+
+  static _SourceCounters _counters(String name) {
+    final counters = _sources[name];
+    if (counters != null) return counters;
+    return _sources.putIfAbsent(
+        _sources.length < maxSources ? name : overflowSource,
+        _SourceCounters.new);
+  }
+
+  /// Short, root-independent name for the source at [path]:
+  /// `cgroup/<file>` for cgroup files (whatever the nesting),
+  /// `proc/...` for procfs, otherwise the path without the leading `/`.
+  /// Numbered components become `<n>` (`proc/<n>/stat`,
+  /// `sys/devices/system/cpu/cpu<n>/...`).
+  static String sourceName(String path) {
+    final cached = _names[path];
+    if (cached != null) return cached;
+    if (_names.length >= _maxNames) _names.clear();
+    return _names[path] = _name(path);
+  }
+
+  static String _name(String path) {
+    final root = PlatformDetector.root;
+    final relative = path.startsWith(root) ? path.substring(root.length) : path;
+    if (relative.startsWith('/sys/fs/cgroup/')) {
+      return 'cgroup/${relative.substring(relative.lastIndexOf('/') + 1)}';
+    }
+    final parts =
+        (relative.startsWith('/') ? relative.substring(1) : relative)
+            .split('/');
+    for (final (i, part) in parts.indexed) {
+      final match = _numbered.firstMatch(part);
+      if (match != null) parts[i] = '${match[1] ?? ''}<n>';
+    }
+    return parts.join('/');
+  }
+
+  /// Resets all counters, including the native library's. Useful for
+  /// testing.
+  static void clearState() {
+    _sources.clear();
+    _names.clear();
+    _reads = 0;
+    _syscalls = 0;
+    _bytes = 0;
+    _readMicros = 0;
+    _samples = 0;
+    _sampleMicros = 0;
+    _minSampleMicros = 0;
+    _maxSampleMicros = 0;
+    _sampleReads = 0;
+    _sampleSyscalls = 0;
+    _sampleBytes = 0;
+    _sampleReadMicros = 0;
+    _tick = null;
+    MacOsNative.resetStats();
+  }
+}
@@ -1,9 +1,26 @@
 import 'dart:io';
 
+import 'adaptive_limiter.dart';
+import 'cpu_frequency.dart';
 import 'cpu_monitor.dart';
+import 'cpu_topology.dart';
+import 'exposition.dart';
+import 'fd_monitor.dart';
 import 'platform_detector.dart';
-import 'memory_monitor.dart';
+import 'memory_budget.dart';
+import 'memory_events.dart';
+import 'memory_peak.dart';
+import 'network_monitor.dart';
+import 'numa_monitor.dart';
 import 'macos_native.dart';
+import 'process_tree.dart';
+import 'quantile_sketch.dart';
+import 'resource_backend.dart';
+import 'resource_sampler.dart';
+import 'self_stats.dart';
+import 'threshold_watcher.dart';
+import 'trace_writer.dart';
+import 'ttl_cache.dart';
 
 /// Provides easy access to system resources (CPU load, memory usage).
 ///
@@ -35,6 +52,20 @@ import 'macos_native.dart';
 /// Memory monitoring reads from cgroup memory controller files, with fallback
 /// to `/proc/meminfo` for non-container environments.
 ///
+/// ## Backends
+///
+/// The metric source (cgroup v2, cgroup v1, `/proc`, macOS native) is
+/// selected once on first use and reused by every getter and the sampler,
+/// so reads do not re-detect the platform.
+///
+/// ## Coalesced Reads
+///
+/// Every metric getter accepts an optional `maxStalenessMicros`. Calls
+/// within that freshness window return the value from the last read
+/// instead of reading the filesystem again, so many request handlers
+/// calling e.g. [memoryUsedBytes] in the same millisecond share one read.
+/// The default of 0 always reads.
+///
 /// ## Example
 ///
 /// ```dart
@@ -56,6 +87,15 @@ import 'macos_native.dart';
 class SystemResources {
   static bool _initialized = false;
 
+  static final _cpuLoadAvgCache = TtlCache<double>();
+  static final _cpuLoadCache = TtlCache<double>();
+  static final _cpuUsageMillicoresCache = TtlCache<int>();
+  static final _cpuUsageMicrosCache = TtlCache<int>();
+  static final _cpuLimitCoresCache = TtlCache<double>();
+  static final _cpuLimitMillicoresCache = TtlCache<int>();
+  static final _memoryLimitBytesCache = TtlCache<int>();
+  static final _memoryUsedBytesCache = TtlCache<int>();
+
   /// Initialize the library.
   ///
   /// This method exists for API compatibility with Serverpod and the original
@@ -81,15 +121,6 @@ class SystemResources {
     }
   }
 
-  /// Ensures macOS FFI is initialized. Throws if init() wasn't called.
-  static void _ensureMacOsInit() {
-    if (!MacOsNative.isInitialized) {
-      throw StateError(
-        'SystemResources not initialized. Call SystemResources.init() first.',
-      );
-    }
-  }
-
   /// Returns `true` if running in a detected container environment.
   ///
   /// Container detection is based on the presence of cgroup memory limits.
@@ -108,24 +139,6 @@ class SystemResources {
   // CPU
   // ---------------------------------------------------------------------------
 
-  /// Returns the cgroup usage-micros reader for the current platform,
-  /// or `null` if the platform doesn't support cgroup CPU accounting.
-  static int Function()? get _usageMicrosReader =>
-      switch (PlatformDetector.detectPlatform()) {
-        DetectedPlatform.linuxCgroupV2 => CpuMonitor.readV2UsageMicros,
-        DetectedPlatform.linuxCgroupV1 => CpuMonitor.readV1UsageMicros,
-        _ => null,
-      };
-
-  /// Returns the cgroup limit-millicores reader for the current platform,
-  /// or `null` if the platform doesn't support cgroup CPU limits.
-  static int Function()? get _limitMillicoresReader =>
-      switch (PlatformDetector.detectPlatform()) {
-        DetectedPlatform.linuxCgroupV2 => CpuMonitor.readV2LimitMillicores,
-        DetectedPlatform.linuxCgroupV1 => CpuMonitor.readV1LimitMillicores,
-        _ => null,
-      };
-
   /// Get CPU load average normalized by CPU limit/count.
   ///
   /// This is the primary CPU monitoring method, compatible with Serverpod
@@ -140,19 +153,10 @@ class SystemResources {
   /// - **macOS**: Uses native FFI (requires [init()] to be called first).
   ///
   /// Returns a value where 1.0 means 100% CPU utilization.
-  static double cpuLoadAvg() => switch (PlatformDetector.detectPlatform()) {
-        DetectedPlatform.macOS => _macOsCpuLoadAvg(),
-        DetectedPlatform.linuxCgroupV2 => CpuMonitor.getLoad(
-            CpuMonitor.readV2UsageMicros,
-            CpuMonitor.readV2LimitMillicores,
-          ),
-        DetectedPlatform.linuxCgroupV1 => CpuMonitor.getLoad(
-            CpuMonitor.readV1UsageMicros,
-            CpuMonitor.readV1LimitMillicores,
-          ),
-        DetectedPlatform.linuxHost => CpuMonitor.readProcLoadAvg(),
-        DetectedPlatform.unsupported => 0.0,
-      };
+  static double cpuLoadAvg({int maxStalenessMicros = 0}) =>
+      _cpuLoadAvgCache.get(maxStalenessMicros, _readCpuLoadAvg);
+
+  static double _readCpuLoadAvg() => ResourceBackend.current.cpuLoadAvg();
 
   /// Get CPU load as a fraction of the limit (cgroup-based only).
   ///
@@ -165,12 +169,10 @@ class SystemResources {
   ///
   /// On non-Linux platforms or hosts without cgroups, returns 0.0.
   /// Use [cpuLoadAvg()] for broader compatibility.
-  static double cpuLoad() {
-    final usageReader = _usageMicrosReader;
-    final limitReader = _limitMillicoresReader;
-    if (usageReader == null || limitReader == null) return 0.0;
-    return CpuMonitor.getLoad(usageReader, limitReader);
-  }
+  static double cpuLoad({int maxStalenessMicros = 0}) =>
+      _cpuLoadCache.get(maxStalenessMicros, _readCpuLoad);
+
+  static double _readCpuLoad() => ResourceBackend.current.cpuLoad();
 
   /// Get CPU usage in millicores (1000m = 1 full CPU core).
   ///
@@ -182,11 +184,12 @@ class SystemResources {
   /// 100ms between calls.
   ///
   /// On non-Linux platforms, always returns 0.
-  static int cpuUsageMillicores() {
-    final reader = _usageMicrosReader;
-    if (reader == null) return 0;
-    return CpuMonitor.getUsageMillicores(reader);
-  }
+  static int cpuUsageMillicores({int maxStalenessMicros = 0}) =>
+      _cpuUsageMillicoresCache.get(
+          maxStalenessMicros, _readCpuUsageMillicores);
+
+  static int _readCpuUsageMillicores() =>
+      ResourceBackend.current.cpuUsageMillicores();
 
   /// Get raw CPU usage in microseconds from cgroup accounting.
   ///
@@ -194,11 +197,11 @@ class SystemResources {
   /// container since it started. Useful for custom delta calculations.
   ///
   /// On non-Linux platforms, always returns 0.
-  static int cpuUsageMicros() => switch (PlatformDetector.detectPlatform()) {
-        DetectedPlatform.linuxCgroupV2 => CpuMonitor.readV2UsageMicros(),
-        DetectedPlatform.linuxCgroupV1 => CpuMonitor.readV1UsageMicros(),
-        _ => 0,
-      };
+  static int cpuUsageMicros({int maxStalenessMicros = 0}) =>
+      _cpuUsageMicrosCache.get(maxStalenessMicros, _readCpuUsageMicros);
+
+  static int _readCpuUsageMicros() =>
+      ResourceBackend.current.cpuUsageMicros();
 
   /// Get the CPU limit in cores.
   ///
@@ -210,28 +213,22 @@ class SystemResources {
   /// The `SYSRES_CPU_CORES` environment variable can be used to override
   /// this value, which is useful for gVisor environments that don't
   /// expose cgroup limits.
-  static double cpuLimitCores() => switch (PlatformDetector.detectPlatform()) {
-        DetectedPlatform.macOS => _macOsCpuLimitCores(),
-        DetectedPlatform.linuxCgroupV2 =>
-          CpuMonitor.getLimitCores(CpuMonitor.readV2LimitMillicores),
-        DetectedPlatform.linuxCgroupV1 =>
-          CpuMonitor.getLimitCores(CpuMonitor.readV1LimitMillicores),
-        DetectedPlatform.linuxHost =>
-          Platform.numberOfProcessors.toDouble(),
-        DetectedPlatform.unsupported =>
-          Platform.numberOfProcessors.toDouble(),
-      };
+  static double cpuLimitCores({int maxStalenessMicros = 0}) =>
+      _cpuLimitCoresCache.get(maxStalenessMicros, _readCpuLimitCores);
+
+  static double _readCpuLimitCores() =>
+      ResourceBackend.current.cpuLimitCores();
 
   /// Get the CPU limit in millicores (1000m = 1 full CPU core).
   ///
   /// Returns -1 if unlimited or unable to determine.
   ///
   /// On non-Linux platforms, returns host CPU count * 1000.
-  static int cpuLimitMillicores() => switch (PlatformDetector.detectPlatform()) {
-        DetectedPlatform.linuxCgroupV2 => CpuMonitor.readV2LimitMillicores(),
-        DetectedPlatform.linuxCgroupV1 => CpuMonitor.readV1LimitMillicores(),
-        _ => Platform.numberOfProcessors * 1000,
-      };
+  static int cpuLimitMillicores({int maxStalenessMicros = 0}) =>
+      _cpuLimitMillicoresCache.get(maxStalenessMicros, _readCpuLimitMillicores);
+
+  static int _readCpuLimitMillicores() =>
+      ResourceBackend.current.cpuLimitMillicores();
 
   // ---------------------------------------------------------------------------
   // Memory
@@ -244,10 +241,10 @@ class SystemResources {
   ///
   /// In a container environment, this is relative to the container's
   /// memory limit. On host, this is relative to total system memory.
-  static double memUsage() {
-    final limit = memoryLimitBytes();
+  static double memUsage({int maxStalenessMicros = 0}) {
+    final limit = memoryLimitBytes(maxStalenessMicros: maxStalenessMicros);
     if (limit <= 0) return 0.0;
-    final used = memoryUsedBytes();
+    final used = memoryUsedBytes(maxStalenessMicros: maxStalenessMicros);
     return used / limit;
   }
 
@@ -255,50 +252,236 @@ class SystemResources {
   ///
   /// In a container environment, returns the container's memory limit.
   /// On host, returns total system memory.
-  static int memoryLimitBytes() => switch (PlatformDetector.detectPlatform()) {
-        DetectedPlatform.macOS => _macOsMemoryLimitBytes(),
-        DetectedPlatform.linuxCgroupV2 => MemoryMonitor.readV2LimitBytes(),
-        DetectedPlatform.linuxCgroupV1 => MemoryMonitor.readV1LimitBytes(),
-        DetectedPlatform.linuxHost => MemoryMonitor.readProcMemTotal(),
-        DetectedPlatform.unsupported => 0,
-      };
+  static int memoryLimitBytes({int maxStalenessMicros = 0}) =>
+      _memoryLimitBytesCache.get(maxStalenessMicros, _readMemoryLimitBytes);
+
+  static int _readMemoryLimitBytes() =>
+      ResourceBackend.current.memoryLimitBytes();
 
   /// Get the memory currently used in bytes.
   ///
   /// In a container environment, returns the container's current memory usage.
   /// On host, returns system memory usage (MemTotal - MemAvailable).
-  static int memoryUsedBytes() => switch (PlatformDetector.detectPlatform()) {
-        DetectedPlatform.macOS => _macOsMemoryUsedBytes(),
-        DetectedPlatform.linuxCgroupV2 => MemoryMonitor.readV2UsedBytes(),
-        DetectedPlatform.linuxCgroupV1 => MemoryMonitor.readV1UsedBytes(),
-        DetectedPlatform.linuxHost => MemoryMonitor.readProcMemUsed(),
-        DetectedPlatform.unsupported => 0,
-      };
+  static int memoryUsedBytes({int maxStalenessMicros = 0}) =>
+      _memoryUsedBytesCache.get(maxStalenessMicros, _readMemoryUsedBytes);
+
+  static int _readMemoryUsedBytes() =>
+      ResourceBackend.current.memoryUsedBytes();
 
   // ---------------------------------------------------------------------------
-  // macOS FFI helpers (guard init)
+  // Sampler
   // ---------------------------------------------------------------------------
 
-  static double _macOsCpuLoadAvg() {
-    _ensureMacOsInit();
-    return MacOsNative.cpuLoadAvg();
-  }
+  /// Starts a background sampler that records CPU utilization, CFS
+  /// throttling and memory working set every [interval].
+  ///
+  /// The sampler keeps bounded-memory quantile sketches of each metric
+  /// over a rolling [window], so callers can tell a steady 60% from
+  /// oscillation between 10% and 110%. Restarts the sampler if running.
+  ///
+  /// Pass [minInterval] and [maxInterval] (e.g. 100ms and 5s) to let the
+  /// sampler adapt its rate: it slows down while utilization and pressure
+  /// are low and stable, and speeds up when metrics change quickly or
+  /// approach a threshold rule. The interval in effect is reported in
+  /// [ResourceSnapshot.samplingInterval].
+  ///
+  /// File descriptor usage changes slowly and can be costly to count on
+  /// older kernels, so it is refreshed only every [fdInterval].
+  ///
+  /// With [processTree], every tick also sums CPU and resident memory over
+  /// this process's descendants (see [processTreeUsage]) into the
+  /// snapshot. It costs a few reads per descendant, so it is off by
+  /// default.
+  static void startSampler({
+    Duration interval = const Duration(seconds: 1),
+    Duration window = const Duration(minutes: 1),
+    Duration? minInterval,
+    Duration? maxInterval,
+    Duration fdInterval = const Duration(seconds: 10),
+    bool processTree = false,
+  }) =>
+      ResourceSampler.start(
+        interval: interval,
+        window: window,
+        minInterval: minInterval,
+        maxInterval: maxInterval,
+        fdInterval: fdInterval,
+        processTree: processTree,
+      );
 
-  static double _macOsCpuLimitCores() {
-    _ensureMacOsInit();
-    return MacOsNative.cpuLimitCores();
-  }
+  /// Stops the background sampler. [snapshot] samples on each call again.
+  static void stopSampler() => ResourceSampler.stop();
 
-  static int _macOsMemoryLimitBytes() {
-    _ensureMacOsInit();
-    return MacOsNative.memoryLimitBytes();
-  }
+  /// Returns the latest sampler snapshot while the sampler is running.
+  ///
+  /// Without a running sampler, samples on every call, so the values are
+  /// never older than the call; the window quantiles then cover the calls
+  /// made within the window.
+  static ResourceSnapshot snapshot() => ResourceSampler.isRunning
+      ? ResourceSampler.latest ?? ResourceSampler.sample()
+      : ResourceSampler.sample();
+
+  /// Broadcast stream of every snapshot taken by the sampler.
+  static Stream<ResourceSnapshot> get snapshots => ResourceSampler.snapshots;
 
-  static int _macOsMemoryUsedBytes() {
-    _ensureMacOsInit();
-    return MacOsNative.memoryUsedBytes();
+  /// p50/p90/p99/max of per-tick CPU utilization (fraction of the limit)
+  /// over the sampler window.
+  static QuantileSummary cpuUtilizationQuantiles() =>
+      snapshot().cpuUtilizationQuantiles;
+
+  /// p50/p90/p99/max of the per-tick CFS throttled ratio over the sampler
+  /// window.
+  static QuantileSummary throttledRatioQuantiles() =>
+      snapshot().throttledRatioQuantiles;
+
+  /// p50/p90/p99/max of the memory working set in bytes over the sampler
+  /// window.
+  static QuantileSummary workingSetQuantiles() =>
+      snapshot().workingSetQuantiles;
+
+  /// Hardware topology of the CPUs this process may run on: physical
+  /// cores and SMT siblings, cache sizes and sharing, and NUMA nodes.
+  ///
+  /// Restricted to the online CPUs in the cgroup cpuset and scheduler
+  /// affinity, so pools, shard counts and buffers sized from it match what
+  /// the process can actually use. Read from sysfs once and cached; on
+  /// macOS only the logical CPU count is known.
+  static CpuTopology cpuTopology() => TopologyReader.read();
+
+  /// Current clock speed of the allowed CPUs relative to their maximum,
+  /// and cumulative thermal throttle events.
+  ///
+  /// A core held at half clock by thermal or power capping does half the
+  /// work per millicore; [CpuFrequency.capacityFactor] (also on every
+  /// [ResourceSnapshot]) makes that visible. Degrades to
+  /// [CpuFrequency.unavailable] (factor 1.0) when cpufreq is not exposed,
+  /// as in most VMs and containers without sysfs.
+  static CpuFrequency cpuFrequency() => CpuFrequencyMonitor.read();
+
+  /// Network throughput per interface, TCP retransmit and error rates,
+  /// and TCP socket buffer usage against `tcp_mem`, for the network
+  /// namespace of this process (the pod's, in Kubernetes).
+  ///
+  /// Rates cover the interval since the previous call and are 0 on the
+  /// first call. The sampler keeps its own rate state, so its ticks do
+  /// not shorten that interval. Empty on macOS.
+  static NetworkStats networkStats() => NetworkMonitor.read();
+
+  /// Open file descriptors of this process and its `RLIMIT_NOFILE` soft
+  /// and hard limits.
+  ///
+  /// On Linux 6.2+ the count is a single `stat` of `/proc/self/fd`;
+  /// older kernels fall back to listing it, which is O(open fds). Pass
+  /// [maxStalenessMicros] to reuse a recent reading; the sampler refreshes
+  /// it every `fdInterval` (see [startSampler]). Unknown on macOS.
+  static FdUsage fdUsage({int maxStalenessMicros = 0}) =>
+      FdMonitor.read(maxStalenessMicros: maxStalenessMicros);
+
+  /// CPU time, resident memory and storage I/O summed over this process
+  /// and every live descendant, plus the CPU time of reaped children
+  /// (`RUSAGE_CHILDREN`), so work done by spawned helpers (image
+  /// converters, shell-outs) is attributed to the process that started
+  /// them rather than lost or mixed with sidecars in the cgroup.
+  ///
+  /// Rates cover the interval since the previous call. Empty on macOS.
+  static ProcessTreeUsage processTreeUsage() => ProcessTreeMonitor.read();
+
+  /// Page fault and reclaim rates since the previous call: how fast memory
+  /// is charged and reclaimed rather than how much is in use, to tell
+  /// allocation churn from a leak. From cgroup v2 `memory.stat`, or
+  /// host-wide from `/proc/vmstat` elsewhere on Linux. Empty on macOS.
+  static MemoryEventRates memoryEvents() => MemoryEventMonitor.read();
+
+  /// Memory per NUMA node: the cgroup's anon and file bytes on each node
+  /// (from `memory.numa_stat` on cgroup v2, node-wide otherwise), node
+  /// totals, and local/remote allocation rates since the previous call.
+  ///
+  /// Use [NumaStats.imbalance] and [NumaStats.remoteAllocRatio] to spot
+  /// pinned workloads whose memory ended up on the wrong node. Empty on
+  /// macOS and on hosts that expose no NUMA nodes.
+  static NumaStats numaStats() => NumaMonitor.read();
+
+  /// Returns [snapshot] in the Prometheus text exposition format. A scrape
+  /// handler without a running sampler samples on every scrape.
+  static String exposition() => ExpositionEncoder.encode(snapshot());
+
+  /// What monitoring itself has cost: time, source reads, system calls
+  /// and bytes per sampler tick, plus read, failure and fallback counts
+  /// per source (including reads made by the getters).
+  ///
+  /// The latest snapshot carries the same figures as of its tick in
+  /// [ResourceSnapshot.overhead].
+  static MonitoringOverhead monitoringOverhead() => SelfStats.current();
+
+  /// Registers a threshold rule evaluated on every sampler tick.
+  ///
+  /// Only state transitions are delivered on [thresholdEvents], which
+  /// replaces Dart-side polling timers for alerting and load shedding.
+  /// Rules are evaluated while the sampler is running (see [startSampler]).
+  /// A rule with the same name replaces the existing one.
+  static void addThresholdRule(ThresholdRule rule) =>
+      ThresholdWatcher.add(rule);
+
+  /// Removes the threshold rule named [name]. Returns `true` if it existed.
+  static bool removeThresholdRule(String name) => ThresholdWatcher.remove(name);
+
+  /// Returns `true` if the threshold rule named [name] is currently active.
+  static bool isThresholdActive(String name) => ThresholdWatcher.isActive(name);
+
+  /// Broadcast stream of threshold rule transitions.
+  static Stream<ThresholdEvent> get thresholdEvents => ThresholdWatcher.events;
+
+  /// Creates an [AdaptiveLimiter] that adjusts its concurrency limit on
+  /// every sampler tick from CFS throttling, PSI CPU pressure and
+  /// working-set headroom.
+  ///
+  /// The limit only adapts while the sampler is running (see
+  /// [startSampler]). Call [AdaptiveLimiter.close] to detach it.
+  static AdaptiveLimiter adaptiveLimiter({
+    int initialLimit = 20,
+    int minLimit = 1,
+    int maxLimit = 1000,
+    double backoffRatio = 0.9,
+    double maxThrottledRatio = 0.1,
+    double maxCpuPressure = 0.1,
+    double minMemoryHeadroom = 0.1,
+  }) =>
+      AdaptiveLimiter(
+        initialLimit: initialLimit,
+        minLimit: minLimit,
+        maxLimit: maxLimit,
+        backoffRatio: backoffRatio,
+        maxThrottledRatio: maxThrottledRatio,
+        maxCpuPressure: maxCpuPressure,
+        minMemoryHeadroom: minMemoryHeadroom,
+      )..attach(ResourceSampler.snapshots);
+
+  /// Creates a [MemoryBudget] for sizing in-process caches.
+  ///
+  /// The budget is [fraction] of the effective memory limit (the lower of
+  /// `memory.high` and `memory.max`) minus the non-cache working set. It is
+  /// computed immediately and then republished on [MemoryBudget.changes]
+  /// whenever a sampler tick moves it by more than [hysteresis]. Call
+  /// [MemoryBudget.close] to detach it.
+  static MemoryBudget memoryBudget(double fraction,
+      {double hysteresis = 0.05}) {
+    final budget = MemoryBudget(fraction, hysteresis: hysteresis)
+      ..update(snapshot())
+      ..attach(ResourceSampler.snapshots);
+    return budget;
   }
 
+  /// Creates a [TraceWriter] that appends every sampler snapshot to [path]
+  /// as Chrome JSON trace counter events on the Dart timeline clock.
+  ///
+  /// The file rotates at [maxBytes], keeping [maxFiles] older files. Events
+  /// are only written while the sampler is running (see [startSampler]).
+  /// Call [TraceWriter.close] to detach it and finish the file.
+  static TraceWriter traceWriter(String path,
+          {int maxBytes = 16 << 20, int maxFiles = 3}) =>
+      TraceWriter(path, maxBytes: maxBytes, maxFiles: maxFiles)
+        ..attach(ResourceSampler.snapshots);
+
   // ---------------------------------------------------------------------------
   // State management
   // ---------------------------------------------------------------------------
@@ -306,11 +489,44 @@ class SystemResources {
   /// Clears all cached state. Useful for testing.
   ///
   /// This resets:
-  /// - Cached platform detection
+  /// - Cached platform detection and selected backend
   /// - Cached container detection
   /// - CPU usage delta state
+  /// - Sampler state (the sampler is stopped)
+  /// - Registered threshold rules
+  /// - Coalesced read caches
+  /// - Self-instrumentation counters
+  /// - Cached CPU topology and cpufreq sources
+  /// - NUMA and network rate state
+  /// - Cached file descriptor usage
+  /// - Process tree rate state
+  /// - The `memory.peak` descriptor and memory event rate state
   static void clearState() {
+    for (final cache in [
+      _cpuLoadAvgCache,
+      _cpuLoadCache,
+      _cpuUsageMillicoresCache,
+      _cpuUsageMicrosCache,
+      _cpuLimitCoresCache,
+      _cpuLimitMillicoresCache,
+      _memoryLimitBytesCache,
+      _memoryUsedBytesCache,
+    ]) {
+      cache.clear();
+    }
     PlatformDetector.clearCache();
+    ResourceBackend.clearCache();
     CpuMonitor.clearState();
+    ResourceSampler.clearState();
+    ThresholdWatcher.clearState();
+    SelfStats.clearState();
+    TopologyReader.clearState();
+    CpuFrequencyMonitor.clearState();
+    NumaMonitor.clearState();
+    NetworkMonitor.clearState();
+    FdMonitor.clearState();
+    ProcessTreeMonitor.clearState();
+    MemoryPeakMonitor.clearState();
+    MemoryEventMonitor.clearState();
   }
 }
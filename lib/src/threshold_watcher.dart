@@ -0,0 +1,238 @@
+import 'dart:async';
+
+import 'resource_sampler.dart';
+
+/// Metrics of a [ResourceSnapshot] that threshold rules can watch.
+enum ResourceMetric {
+  /// CPU usage as a fraction of the CPU limit over the last tick.
+  cpuUtilization,
+
+  /// CPU usage in millicores over the last tick.
+  cpuUsageMillicores,
+
+  /// Fraction of CFS periods throttled over the last tick.
+  throttledRatio,
+
+  /// Memory used as a fraction of the memory limit (0.0 - 1.0).
+  memoryUsage,
+
+  /// Memory used in bytes.
+  memoryUsedBytes,
+
+  /// Memory working set in bytes.
+  workingSetBytes,
+
+  /// Highest memory usage in bytes since the previous tick.
+  memoryPeakBytes,
+
+  /// PSI `some avg10` for CPU as a fraction.
+  cpuPressure,
+
+  /// PSI `some avg10` for memory as a fraction.
+  memoryPressure;
+
+  /// Extracts this metric from [snapshot].
+  double valueOf(ResourceSnapshot snapshot) => switch (this) {
+        ResourceMetric.cpuUtilization => snapshot.cpuUtilization,
+        ResourceMetric.cpuUsageMillicores =>
+          snapshot.cpuUsageMillicores.toDouble(),
+        ResourceMetric.throttledRatio => snapshot.throttledRatio,
+        ResourceMetric.memoryUsage => snapshot.memoryLimitBytes > 0
+            ? snapshot.memoryUsedBytes / snapshot.memoryLimitBytes
+            : 0.0,
+        ResourceMetric.memoryUsedBytes =>
+          snapshot.memoryUsedBytes.toDouble(),
+        ResourceMetric.workingSetBytes => snapshot.workingSetBytes.toDouble(),
+        ResourceMetric.memoryPeakBytes => snapshot.memoryPeakBytes.toDouble(),
+        ResourceMetric.cpuPressure => snapshot.cpuPressure,
+        ResourceMetric.memoryPressure => snapshot.memoryPressure,
+      };
+}
+
+/// Direction in which a [ThresholdRule] fires.
+enum ThresholdComparator {
+  /// Fires when the value rises above `enter`, clears below `exit`.
+  above,
+
+  /// Fires when the value drops below `enter`, clears above `exit`.
+  below,
+}
+
+/// A declarative threshold with hysteresis and dwell time.
+///
+/// For example, "memory usage > 85% for 5s, clear below 75%":
+///
+/// ```dart
+/// ThresholdRule(
+///   name: 'memory-high',
+///   metric: ResourceMetric.memoryUsage,
+///   comparator: ThresholdComparator.above,
+///   enter: 0.85,
+///   exit: 0.75,
+///   dwell: Duration(seconds: 5),
+/// );
+/// ```
+///
+/// The [dwell] applies to both entering and clearing, so a single noisy
+/// sample never causes a transition.
+class ThresholdRule {
+  final String name;
+  final ResourceMetric metric;
+  final ThresholdComparator comparator;
+  final double enter;
+
+  /// Defaults to [enter] (no hysteresis).
+  final double exit;
+
+  final Duration dwell;
+
+  /// Throws [ArgumentError] if [exit] is on the wrong side of [enter].
+  ThresholdRule({
+    required this.name,
+    required this.metric,
+    required this.comparator,
+    required this.enter,
+    double? exit,
+    this.dwell = Duration.zero,
+  }) : exit = exit ?? enter {
+    final inverted = comparator == ThresholdComparator.above
+        ? this.exit > enter
+        : this.exit < enter;
+    if (inverted) {
+      throw ArgumentError.value(
+          this.exit, 'exit', 'Must not be past enter ($enter) for $comparator');
+    }
+  }
+
+  bool _entered(double value) => comparator == ThresholdComparator.above
+      ? value > enter
+      : value < enter;
+
+  bool _cleared(double value) => comparator == ThresholdComparator.above
+      ? value < exit
+      : value > exit;
+
+  @override
+  String toString() => 'ThresholdRule($name: ${metric.name} '
+      '${comparator.name} $enter, exit $exit, dwell $dwell)';
+}
+
+/// A state transition of a [ThresholdRule].
+class ThresholdEvent {
+  final ThresholdRule rule;
+
+  /// `true` when the rule became active, `false` when it cleared.
+  final bool active;
+
+  /// The metric value that completed the transition.
+  final double value;
+
+  /// Monotonic timestamp of the sample, in microseconds.
+  final int timestampMicros;
+
+  const ThresholdEvent({
+    required this.rule,
+    required this.active,
+    required this.value,
+    required this.timestampMicros,
+  });
+
+  @override
+  String toString() =>
+      'ThresholdEvent(${rule.name}, ${active ? 'active' : 'cleared'}, $value)';
+}
+
+class _RuleState {
+  final ThresholdRule rule;
+  bool active = false;
+  int? pendingSinceMicros;
+
+  _RuleState(this.rule);
+}
+
+/// Evaluates registered [ThresholdRule]s on every sampler tick and emits
+/// only state transitions on [events].
+class ThresholdWatcher {
+  static final List<_RuleState> _states = [];
+  static final StreamController<ThresholdEvent> _events =
+      StreamController<ThresholdEvent>.broadcast();
+
+  /// Transitions of all registered rules.
+  static Stream<ThresholdEvent> get events => _events.stream;
+
+  static List<ThresholdRule> get rules =>
+      List.unmodifiable(_states.map((s) => s.rule));
+
+  /// Registers [rule]. Replaces any rule with the same name.
+  static void add(ThresholdRule rule) {
+    remove(rule.name);
+    _states.add(_RuleState(rule));
+  }
+
+  /// Removes the rule named [name]. Returns `true` if it existed.
+  static bool remove(String name) {
+    final before = _states.length;
+    _states.removeWhere((s) => s.rule.name == name);
+    return _states.length != before;
+  }
+
+  /// Returns `true` if the rule named [name] is currently active.
+  static bool isActive(String name) =>
+      _states.any((s) => s.rule.name == name && s.active);
+
+  /// Returns `true` if any rule is pending, or its metric in [snapshot]
+  /// could soon make it transition: within [margin] (relative) of the
+  /// enter threshold for an inactive rule, and for an active rule back in
+  /// its hysteresis band or within [margin] past the enter threshold.
+  /// An active rule whose metric is far past its threshold is not near.
+  ///
+  /// Used by the sampler to speed up near thresholds.
+  static bool isNear(ResourceSnapshot snapshot, {double margin = 0.1}) {
+    for (final state in _states) {
+      if (state.pendingSinceMicros != null) return true;
+
+      final rule = state.rule;
+      final value = rule.metric.valueOf(snapshot);
+      final band = rule.enter.abs() * margin;
+      final above = rule.comparator == ThresholdComparator.above;
+      final near = state.active
+          ? (above ? value <= rule.enter + band : value >= rule.enter - band)
+          : (above ? value >= rule.enter - band : value <= rule.enter + band);
+      if (near) return true;
+    }
+    return false;
+  }
+
+  /// Advances every rule with [snapshot]. Called by the sampler.
+  static void evaluate(ResourceSnapshot snapshot) {
+    final now = snapshot.timestampMicros;
+    for (final state in _states) {
+      final rule = state.rule;
+      final value = rule.metric.valueOf(snapshot);
+      final crossing =
+          state.active ? rule._cleared(value) : rule._entered(value);
+
+      if (!crossing) {
+        state.pendingSinceMicros = null;
+        continue;
+      }
+
+      final since = state.pendingSinceMicros ??= now;
+      if (now - since < rule.dwell.inMicroseconds) continue;
+
+      state.active = !state.active;
+      state.pendingSinceMicros = null;
+      if (_events.hasListener) {
+        _events.add(ThresholdEvent(
+          rule: rule,
+          active: state.active,
+          value: value,
+          timestampMicros: now,
+        ));
+      }
+    }
+  }
+
+  /// Removes all rules. Useful for testing.
+  static void clearState() => _states.clear();
+}
@@ -0,0 +1,162 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:developer';
+import 'dart:io';
+
+import 'resource_sampler.dart';
+
+/// Writes sampler snapshots as Chrome JSON trace counter (`"ph": "C"`)
+/// events to a rotating file.
+///
+/// Timestamps are on the Dart timeline clock ([Timeline.now], which is
+/// `CLOCK_MONOTONIC` on Linux and Android), so the file can be loaded in
+/// Perfetto or `chrome://tracing` next to a Dart timeline capture or a
+/// `perf record -k CLOCK_MONOTONIC` trace and the counter tracks line up
+/// with the request spans. Events carry this process's pid.
+///
+/// Files use the JSON array format, whose closing `]` is optional, so a
+/// file cut short by a crash still loads. When the current file would grow
+/// past [maxBytes] it is closed and renamed to `<path>.1`, older files
+/// shift up and at most [maxFiles] rotated files are kept.
+///
+/// ```dart
+/// SystemResources.startSampler();
+/// final trace = SystemResources.traceWriter('/tmp/sysres.trace.json');
+/// // ...
+/// await trace.close();
+/// ```
+class TraceWriter {
+  /// Category of every event, for filtering in trace viewers.
+  static const category = 'sysres';
+
+  final String path;
+  final int maxBytes;
+  final int maxFiles;
+
+  // Offset from the sampler clock to the timeline clock. Both are
+  // monotonic, so it is fixed for the life of the process.
+  final int _clockOffsetMicros;
+
+  RandomAccessFile? _file;
+  int _bytes = 0;
+  bool _empty = true;
+  StreamSubscription<ResourceSnapshot>? _subscription;
+
+  TraceWriter(this.path, {this.maxBytes = 16 << 20, this.maxFiles = 3})
+      : _clockOffsetMicros = Timeline.now - ResourceSampler.nowMicros() {
+    if (maxBytes < 4096) {
+      throw ArgumentError.value(maxBytes, 'maxBytes', 'Must be >= 4096');
+    }
+    if (maxFiles < 0) {
+      throw ArgumentError.value(maxFiles, 'maxFiles', 'Must be >= 0');
+    }
+  }
+
+  /// Timeline timestamp, in microseconds, of [snapshot].
+  int timestampMicros(ResourceSnapshot snapshot) =>
+      snapshot.timestampMicros + _clockOffsetMicros;
+
+  /// Appends one counter event per metric of [snapshot]. Called on every
+  /// sampler tick when attached.
+  void write(ResourceSnapshot snapshot) {
+    final ts = timestampMicros(snapshot);
+    final out = StringBuffer();
+    void counter(String name, num value) {
+      // JSON has no NaN or infinity; leave a gap in the track instead.
+      if (!value.isFinite) return;
+      out
+        ..write(_empty && out.isEmpty ? '' : ',\n')
+        ..write(jsonEncode({
+          'name': name,
+          'cat': category,
+          'ph': 'C',
+          'ts': ts,
+          'pid': pid,
+          'args': {'value': value},
+        }));
+    }
+
+    counter('cpu_utilization_ratio', snapshot.cpuUtilization);
+    counter('cpu_usage_millicores', snapshot.cpuUsageMillicores);
+    counter('cpu_limit_millicores', (snapshot.cpuLimitCores * 1000).round());
+    counter('cpu_throttled_ratio', snapshot.throttledRatio);
+    counter('memory_used_bytes', snapshot.memoryUsedBytes);
+    counter('memory_working_set_bytes', snapshot.workingSetBytes);
+    counter('memory_peak_bytes', snapshot.memoryPeakBytes);
+    counter('memory_page_faults_per_second', snapshot.pageFaultsPerSecond);
+    counter('memory_page_scans_per_second', snapshot.pageScansPerSecond);
+    counter('memory_page_steals_per_second', snapshot.pageStealsPerSecond);
+    counter('memory_reclaim_efficiency_ratio', snapshot.reclaimEfficiency);
+    counter('memory_limit_bytes', snapshot.memoryLimitBytes);
+    counter('cpu_pressure_some_avg10_ratio', snapshot.cpuPressure);
+    counter('memory_pressure_some_avg10_ratio', snapshot.memoryPressure);
+    counter('cpu_capacity_factor_ratio', snapshot.cpuCapacityFactor);
+    counter('cpu_thermal_throttle_events', snapshot.thermalThrottleEvents);
+    counter('network_receive_bytes_per_second',
+        snapshot.networkReceiveBytesPerSecond);
+    counter('network_transmit_bytes_per_second',
+        snapshot.networkTransmitBytesPerSecond);
+    counter('tcp_retransmits_per_second', snapshot.tcpRetransmitsPerSecond);
+    counter('tcp_memory_pressure_ratio', snapshot.tcpMemoryPressure);
+    counter('process_open_fds', snapshot.openFileDescriptors);
+    if (snapshot.processTreeProcesses > 0) {
+      counter('process_tree_cpu_usage_millicores',
+          snapshot.processTreeCpuMillicores);
+      counter('process_tree_rss_bytes', snapshot.processTreeRssBytes);
+    }
+    if (out.isEmpty) return;
+
+    if (!_empty && _bytes + out.length > maxBytes) {
+      _rotate();
+      // The new file starts without a separator.
+      write(snapshot);
+      return;
+    }
+    final file = _file ??= _open();
+    final text = out.toString();
+    file.writeStringSync(text);
+    _bytes += text.length;
+    _empty = false;
+  }
+
+  /// Writes every snapshot of [snapshots] until [close].
+  void attach(Stream<ResourceSnapshot> snapshots) {
+    _subscription?.cancel();
+    _subscription = snapshots.listen(write);
+  }
+
+  /// Stops following sampler snapshots and closes the current file.
+  Future<void> close() async {
+    await _subscription?.cancel();
+    _subscription = null;
+    _finish();
+  }
+
+  RandomAccessFile _open() {
+    final file = File(path).openSync(mode: FileMode.writeOnly);
+    file.writeStringSync('[\n');
+    _bytes = 2;
+    _empty = true;
+    return file;
+  }
+
+  void _finish() {
+    final file = _file;
+    if (file == null) return;
+    _file = null;
+    file
+      ..writeStringSync('\n]\n')
+      ..closeSync();
+  }
+
+  void _rotate() {
+    _finish();
+    for (var i = maxFiles; i >= 1; i--) {
+      final older = File(i == 1 ? path : '$path.${i - 1}');
+      if (!older.existsSync()) continue;
+      older.renameSync('$path.$i');
+    }
+    if (maxFiles == 0) File(path).deleteSync();
+    _empty = true;
+  }
+}
@@ -0,0 +1,33 @@
+/// Caches the last value of a reader for a caller-chosen freshness window.
+///
+/// Calls with `maxStalenessMicros > 0` return the cached value while it is
+/// younger than the window; the first call after the window expires does
+/// the read and refreshes the cache for everyone else. A Dart isolate is
+/// single-threaded, so this "first caller refreshes" protocol needs no
+/// locks or atomics: concurrent request handlers in the same isolate
+/// share one read per window and otherwise pay only a field load.
+class TtlCache<T> {
+  static final Stopwatch _clock = Stopwatch()..start();
+
+  late T _value;
+  int _readAtMicros = -1;
+
+  /// Returns the cached value if it is at most [maxStalenessMicros] old,
+  /// otherwise calls [read] and caches the result.
+  ///
+  /// A [maxStalenessMicros] of 0 always reads (and refreshes the cache).
+  T get(int maxStalenessMicros, T Function() read) {
+    final now = _clock.elapsedMicroseconds;
+    if (maxStalenessMicros > 0 &&
+        _readAtMicros >= 0 &&
+        now - _readAtMicros <= maxStalenessMicros) {
+      return _value;
+    }
+    _value = read();
+    _readAtMicros = now;
+    return _value;
+  }
+
+  /// Drops the cached value.
+  void clear() => _readAtMicros = -1;
+}
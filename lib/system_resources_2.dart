@@ -24,5 +24,22 @@
 /// ```
 library;
 
+export 'src/adaptive_limiter.dart' show AdaptiveLimiter;
+export 'src/cpu_frequency.dart' show CpuFrequency;
+export 'src/cpu_topology.dart' show CacheLevel, CpuTopology;
+export 'src/fd_monitor.dart' show FdUsage;
+export 'src/memory_budget.dart' show MemoryBudget;
+export 'src/memory_events.dart' show MemoryEventRates;
+export 'src/network_monitor.dart'
+    show NetworkInterfaceStats, NetworkStats;
+export 'src/numa_monitor.dart' show NumaNodeStats, NumaStats;
 export 'src/platform_detector.dart' show CgroupVersion, DetectedPlatform;
+export 'src/process_tree.dart' show ProcessTreeUsage;
+export 'src/quantile_sketch.dart'
+    show QuantileSketch, QuantileSummary, WindowedQuantileSketch;
+export 'src/resource_sampler.dart' show ResourceSnapshot;
+export 'src/self_stats.dart' show MonitoringOverhead, SourceStats;
 export 'src/system_resources.dart' show SystemResources;
+export 'src/threshold_watcher.dart'
+    show ResourceMetric, ThresholdComparator, ThresholdEvent, ThresholdRule;
+export 'src/trace_writer.dart' show TraceWriter;
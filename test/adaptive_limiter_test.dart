@@ -0,0 +1,71 @@
+import 'package:system_resources_2/src/adaptive_limiter.dart';
+import 'package:system_resources_2/src/quantile_sketch.dart';
+import 'package:system_resources_2/src/resource_sampler.dart';
+import 'package:test/test.dart';
+
+ResourceSnapshot _snapshot({
+  double throttledRatio = 0,
+  double cpuPressure = 0,
+  int workingSetBytes = 100,
+}) =>
+    ResourceSnapshot(
+      timestampMicros: 0,
+      cpuUtilization: 0,
+      cpuUsageMillicores: 0,
+      cpuLimitCores: 1,
+      throttledRatio: throttledRatio,
+      memoryUsedBytes: workingSetBytes,
+      workingSetBytes: workingSetBytes,
+      memoryLimitBytes: 1000,
+      cpuPressure: cpuPressure,
+      cpuUtilizationQuantiles: QuantileSummary.empty,
+      throttledRatioQuantiles: QuantileSummary.empty,
+      workingSetQuantiles: QuantileSummary.empty,
+    );
+
+void main() {
+  group('AdaptiveLimiter', () {
+    test('rejects beyond the limit and accepts after release', () {
+      final limiter = AdaptiveLimiter(initialLimit: 2);
+
+      expect(limiter.tryAcquire(), isTrue);
+      expect(limiter.tryAcquire(), isTrue);
+      expect(limiter.tryAcquire(), isFalse);
+      expect(limiter.rejected, equals(1));
+
+      limiter.release();
+      expect(limiter.tryAcquire(), isTrue);
+    });
+
+    test('backs off multiplicatively under each overload signal', () {
+      for (final overloaded in [
+        _snapshot(throttledRatio: 0.5),
+        _snapshot(cpuPressure: 0.5),
+        _snapshot(workingSetBytes: 950),
+      ]) {
+        final limiter = AdaptiveLimiter(initialLimit: 100);
+        limiter.update(overloaded);
+        expect(limiter.limit, equals(90));
+      }
+    });
+
+    test('never drops below minLimit', () {
+      final limiter = AdaptiveLimiter(initialLimit: 2, minLimit: 2);
+      limiter.update(_snapshot(throttledRatio: 1));
+      expect(limiter.limit, equals(2));
+    });
+
+    test('grows additively only while utilized', () {
+      final limiter = AdaptiveLimiter(initialLimit: 10);
+
+      limiter.update(_snapshot());
+      expect(limiter.limit, equals(10), reason: 'idle limiter must not grow');
+
+      for (var i = 0; i < 5; i++) {
+        limiter.tryAcquire();
+      }
+      limiter.update(_snapshot());
+      expect(limiter.limit, equals(11));
+    });
+  });
+}
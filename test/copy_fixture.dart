@@ -0,0 +1,19 @@
+import 'dart:io';
+
+import 'package:test/test.dart';
+
+/// Copies the fixture tree [name] from `test/fixtures/` to a temporary
+/// directory that the current test may modify. The copy is deleted when
+/// the test ends, whether it passed or failed.
+Directory copyFixture(String name) {
+  final from = Directory('test/fixtures/$name');
+  final to = Directory.systemTemp.createTempSync('sysres_fixture');
+  addTearDown(() => to.deleteSync(recursive: true));
+  for (final entity in from.listSync(recursive: true)) {
+    if (entity is! File) continue;
+    File('${to.path}${entity.path.substring(from.path.length)}')
+      ..createSync(recursive: true)
+      ..writeAsBytesSync(entity.readAsBytesSync());
+  }
+  return to;
+}
@@ -0,0 +1,63 @@
+import 'dart:io';
+
+import 'package:system_resources_2/src/platform_detector.dart';
+import 'package:system_resources_2/src/resource_sampler.dart';
+import 'package:system_resources_2/system_resources_2.dart';
+import 'package:test/test.dart';
+
+import 'copy_fixture.dart';
+
+void main() {
+  tearDown(() {
+    PlatformDetector.setRoot(null);
+    SystemResources.clearState();
+  });
+
+  group('CpuFrequencyMonitor', () {
+    test('averages the allowed CPUs only', () {
+      PlatformDetector.setRoot('test/fixtures/cgroup-v2');
+      SystemResources.clearState();
+      final frequency = SystemResources.cpuFrequency();
+
+      // cpuset 0-1,4-5: CPUs 0 and 4 run at half clock.
+      expect(frequency.available, isTrue);
+      expect(frequency.capacityFactor, closeTo(0.75, 1e-9));
+      expect(frequency.currentKhz, equals(2250000));
+      expect(frequency.maxKhz, equals(3000000));
+    });
+
+    test('sums core throttles once per core and package once', () {
+      PlatformDetector.setRoot('test/fixtures/cgroup-v2');
+      SystemResources.clearState();
+
+      // Cores 0 and 1 (10 + 5) plus package 0 (2).
+      expect(SystemResources.cpuFrequency().thermalThrottleCount, equals(17));
+    });
+
+    test('is unavailable without cpufreq', () {
+      PlatformDetector.setRoot('test/fixtures/host-256cpu');
+      SystemResources.clearState();
+      final frequency = SystemResources.cpuFrequency();
+
+      expect(frequency.available, isFalse);
+      expect(frequency.capacityFactor, equals(1.0));
+      expect(frequency.thermalThrottleCount, equals(0));
+    });
+
+    test('snapshots carry the factor and throttle events per tick', () {
+      final root = copyFixture('cgroup-v2');
+      PlatformDetector.setRoot(root.path);
+      SystemResources.clearState();
+
+      final first = ResourceSampler.sample();
+      expect(first.cpuCapacityFactor, closeTo(0.75, 1e-9));
+      expect(first.thermalThrottleEvents, equals(0));
+
+      File('${root.path}/sys/devices/system/cpu/cpu1/thermal_throttle/'
+              'core_throttle_count')
+          .writeAsStringSync('8\n');
+      final second = ResourceSampler.sample();
+      expect(second.thermalThrottleEvents, equals(3));
+    });
+  });
+}
@@ -0,0 +1,87 @@
+import 'package:system_resources_2/src/cpu_topology.dart';
+import 'package:system_resources_2/src/platform_detector.dart';
+import 'package:system_resources_2/system_resources_2.dart';
+import 'package:test/test.dart';
+
+void main() {
+  void useFixture(String name) {
+    PlatformDetector.setRoot('test/fixtures/$name');
+    SystemResources.clearState();
+  }
+
+  tearDown(() {
+    PlatformDetector.setRoot(null);
+    SystemResources.clearState();
+  });
+
+  group('TopologyReader', () {
+    test('parses CPU lists and cache sizes', () {
+      expect(TopologyReader.parseCpuList('0-2,8,10-11\n'),
+          equals([0, 1, 2, 8, 10, 11]));
+      expect(TopologyReader.parseCpuList(''), isEmpty);
+      expect(TopologyReader.parseCacheSize('48K'), equals(48 * 1024));
+      expect(TopologyReader.parseCacheSize('32M'), equals(32 << 20));
+      expect(TopologyReader.parseCacheSize('big'), isNull);
+    });
+
+    test('intersects online CPUs with the cpuset', () {
+      useFixture('cgroup-v2');
+      final topology = SystemResources.cpuTopology();
+
+      expect(topology.cpus, equals([0, 1, 4, 5]));
+      expect(topology.cores, equals([
+        [0, 4],
+        [1, 5],
+      ]));
+      expect(topology.physicalCores, equals(2));
+      expect(topology.threadsPerCore, equals(2));
+      expect(topology.packages, equals(1));
+    });
+
+    test('reports cache sizes and sharing', () {
+      useFixture('cgroup-v2');
+      final topology = SystemResources.cpuTopology();
+
+      expect(topology.l1d!.sizeBytes, equals(48 * 1024));
+      expect(topology.l1d!.lineBytes, equals(64));
+      expect(topology.l1d!.sharedByCpus, equals(2));
+      expect(topology.l1d!.instances, equals(2));
+      expect(topology.cache(1, 'Instruction')!.sizeBytes, equals(32 * 1024));
+      expect(topology.l2!.sizeBytes, equals(1280 * 1024));
+      expect(topology.l3!.sizeBytes, equals(12 << 20));
+      expect(topology.l3!.sharedByCpus, equals(4));
+      expect(topology.l3!.instances, equals(1));
+      expect(topology.caches.map((c) => c.level), equals([1, 1, 2, 3]));
+    });
+
+    test('keeps only NUMA nodes with allowed CPUs', () {
+      useFixture('cgroup-v2');
+      expect(SystemResources.cpuTopology().numaNodes, equals({
+        0: [0, 1, 4, 5],
+      }));
+    });
+
+    test('is flat when sysfs has no topology', () {
+      useFixture('host-256cpu');
+      final topology = SystemResources.cpuTopology();
+
+      expect(topology.logicalCpus, equals(256));
+      expect(topology.physicalCores, equals(256));
+      expect(topology.threadsPerCore, equals(1));
+      expect(topology.caches, isEmpty);
+      expect(topology.numaNodes.keys, equals([0]));
+    });
+
+    test('is read once', () {
+      useFixture('cgroup-v2');
+      SystemResources.cpuTopology();
+      final reads = SystemResources.monitoringOverhead().sources.values
+          .fold(0, (sum, stats) => sum + stats.reads);
+      SystemResources.cpuTopology();
+      expect(
+          SystemResources.monitoringOverhead().sources.values
+              .fold(0, (sum, stats) => sum + stats.reads),
+          equals(reads));
+    });
+  });
+}
@@ -0,0 +1,65 @@
+import 'dart:io';
+
+import 'package:system_resources_2/src/platform_detector.dart';
+import 'package:system_resources_2/src/resource_sampler.dart';
+import 'package:system_resources_2/system_resources_2.dart';
+import 'package:test/test.dart';
+
+import 'copy_fixture.dart';
+
+void main() {
+  tearDown(() {
+    PlatformDetector.setRoot(null);
+    SystemResources.clearState();
+  });
+
+  group('FdMonitor', () {
+    test('counts descriptors and reads RLIMIT_NOFILE', () {
+      PlatformDetector.setRoot('test/fixtures/cgroup-v2');
+      SystemResources.clearState();
+      final fds = SystemResources.fdUsage();
+
+      expect(fds.open, equals(12));
+      expect(fds.softLimit, equals(1024));
+      expect(fds.hardLimit, equals(1048576));
+      expect(fds.usage, closeTo(12 / 1024, 1e-9));
+    });
+
+    test('counts this process on the live filesystem', () {
+      if (!Platform.isLinux) return;
+      final fds = SystemResources.fdUsage();
+
+      // At least stdin, stdout and stderr.
+      expect(fds.open, greaterThanOrEqualTo(3));
+      expect(fds.softLimit, isNot(equals(0)));
+    });
+
+    test('the sampler refreshes at its own cadence', () {
+      final root = copyFixture('cgroup-v2');
+      PlatformDetector.setRoot(root.path);
+      SystemResources.clearState();
+
+      expect(ResourceSampler.sample().openFileDescriptors, equals(12));
+      File('${root.path}/proc/self/fd/12').createSync();
+      // Still within fdInterval: the cached count is reused.
+      final snapshot = ResourceSampler.sample();
+      expect(snapshot.openFileDescriptors, equals(12));
+      expect(snapshot.fileDescriptorLimit, equals(1024));
+      expect(SystemResources.fdUsage().open, equals(13));
+    });
+
+    test('is unknown without /proc/self', () {
+      PlatformDetector.setRoot('test/fixtures/host-256cpu');
+      SystemResources.clearState();
+      final fds = SystemResources.fdUsage();
+
+      expect(fds.softLimit, equals(0));
+      expect(fds.usage, equals(0.0));
+    });
+
+    test('rejects a non-positive fdInterval', () {
+      expect(() => SystemResources.startSampler(fdInterval: Duration.zero),
+          throwsArgumentError);
+    });
+  });
+}
@@ -0,0 +1,144 @@
+import 'dart:io';
+
+import 'package:system_resources_2/src/platform_detector.dart';
+import 'package:system_resources_2/src/resource_backend.dart';
+import 'package:system_resources_2/system_resources_2.dart';
+import 'package:test/test.dart';
+
+import 'copy_fixture.dart';
+
+/// Runs the readers against the fixture trees in `test/fixtures/`.
+void main() {
+  void useFixtureRoot(String path) {
+    PlatformDetector.setRoot(path);
+    SystemResources.clearState();
+  }
+
+  void useFixture(String name) => useFixtureRoot('test/fixtures/$name');
+
+  tearDown(() {
+    PlatformDetector.setRoot(null);
+    SystemResources.clearState();
+  });
+
+  group('Fixture: cgroup v2 container', () {
+    setUp(() => useFixture('cgroup-v2'));
+
+    test('detects cgroup v2 container', () {
+      expect(SystemResources.cgroupVersion(), equals(CgroupVersion.v2));
+      expect(SystemResources.isContainerEnv(), isTrue);
+      expect(PlatformDetector.isGVisor(), isFalse);
+    });
+
+    test('reads limits and usage', () {
+      expect(SystemResources.cpuLimitCores(), equals(1.5));
+      expect(SystemResources.cpuLimitMillicores(), equals(1500));
+      expect(SystemResources.memoryLimitBytes(), equals(536870912));
+      expect(SystemResources.memoryUsedBytes(), equals(268435456));
+      expect(SystemResources.memUsage(), equals(0.5));
+    });
+
+    test('batched read includes working set, memory.high and PSI', () {
+      final readings = ResourceBackend.current.readAll();
+
+      expect(readings.cpuUsageMicros, equals(52000000));
+      expect(readings.throttlePeriods, equals(1000));
+      expect(readings.throttledPeriods, equals(50));
+      expect(readings.workingSetBytes, equals(201326592));
+      expect(readings.effectiveMemoryLimitBytes, equals(402653184));
+      expect(readings.cpuPressure, closeTo(0.12, 1e-9));
+      expect(readings.memoryPressure, closeTo(0.01, 1e-9));
+    });
+  });
+
+  group('Fixture: cgroup v1 container', () {
+    setUp(() => useFixture('cgroup-v1'));
+
+    test('detects cgroup v1 container', () {
+      expect(SystemResources.cgroupVersion(), equals(CgroupVersion.v1));
+      expect(SystemResources.isContainerEnv(), isTrue);
+    });
+
+    test('reads limits, usage and throttling', () {
+      expect(SystemResources.cpuLimitCores(), equals(0.5));
+      expect(SystemResources.cpuUsageMicros(), equals(30000000));
+      expect(SystemResources.memoryLimitBytes(), equals(268435456));
+      expect(SystemResources.memoryUsedBytes(), equals(134217728));
+
+      final readings = ResourceBackend.current.readAll();
+      expect(readings.workingSetBytes, equals(100663296));
+      expect(readings.throttledPeriods, equals(400));
+    });
+  });
+
+  group('Fixture: nested systemd scope', () {
+    setUp(() => useFixture('systemd-nested'));
+
+    test('resolves the session scope directory', () {
+      expect(PlatformDetector.resolveCgroupDir(),
+          endsWith('/user.slice/user-1000.slice/session-2.scope'));
+      expect(SystemResources.isContainerEnv(), isFalse);
+    });
+
+    test('falls back to host memory when unlimited', () {
+      expect(SystemResources.cpuLimitMillicores(), equals(-1));
+      expect(SystemResources.memoryLimitBytes(), equals(32607032 * 1024));
+      expect(SystemResources.memoryUsedBytes(), equals(1073741824));
+    });
+  });
+
+  group('Fixture: gVisor', () {
+    setUp(() => useFixture('gvisor'));
+
+    test('detects gVisor and selects its backend', () {
+      expect(PlatformDetector.isGVisor(), isTrue);
+      expect(SystemResources.isContainerEnv(), isTrue);
+      expect(ResourceBackend.current, isA<GVisorBackend>());
+    });
+
+    test('detects the gofer root mount without the version signature', () {
+      final root = copyFixture('gvisor');
+      File('${root.path}/proc/version')
+          .writeAsStringSync('Linux version 6.8.0 #1 SMP PREEMPT_DYNAMIC\n');
+      useFixtureRoot(root.path);
+
+      expect(PlatformDetector.isGVisor(), isTrue);
+    });
+
+    test('does not treat other 9p roots as gVisor', () {
+      final root = copyFixture('gvisor');
+      File('${root.path}/proc/version')
+          .writeAsStringSync('Linux version 6.8.0 #1 SMP PREEMPT_DYNAMIC\n');
+      // A Kata or QEMU guest sharing its rootfs over virtio.
+      File('${root.path}/proc/self/mountinfo').writeAsStringSync(
+          '1 0 0:1 / / rw,relatime - 9p kataShared '
+          'rw,trans=virtio,version=9p2000.L,cache=mmap\n');
+      useFixtureRoot(root.path);
+
+      expect(PlatformDetector.isGVisor(), isFalse);
+      expect(ResourceBackend.current, isNot(isA<GVisorBackend>()));
+    });
+
+    test('reads limits from the downward API', () {
+      expect(SystemResources.cpuLimitCores(), equals(0.5));
+      expect(SystemResources.memoryLimitBytes(), equals(1073741824));
+      expect(SystemResources.memoryUsedBytes(), equals(268435456));
+      expect(ResourceBackend.current.readAll().cpuPressure, equals(0.0));
+    });
+  });
+
+  group('Fixture: 256-CPU host', () {
+    setUp(() => useFixture('host-256cpu'));
+
+    test('counts CPUs from the fixture', () {
+      expect(SystemResources.cgroupVersion(), equals(CgroupVersion.none));
+      expect(PlatformDetector.cpuCount(), equals(256));
+      expect(SystemResources.cpuLimitMillicores(), equals(256000));
+    });
+
+    test('normalizes load average by the CPU count', () {
+      expect(SystemResources.cpuLoadAvg(), equals(0.25));
+      expect(SystemResources.memoryLimitBytes(), equals(1056763904 * 1024));
+    });
+  });
+}
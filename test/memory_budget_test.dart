@@ -0,0 +1,68 @@
+import 'package:system_resources_2/src/memory_budget.dart';
+import 'package:system_resources_2/src/quantile_sketch.dart';
+import 'package:system_resources_2/src/resource_sampler.dart';
+import 'package:test/test.dart';
+
+ResourceSnapshot _snapshot({
+  required int workingSetBytes,
+  int limitBytes = 1000,
+  int effectiveLimitBytes = 0,
+}) =>
+    ResourceSnapshot(
+      timestampMicros: 0,
+      cpuUtilization: 0,
+      cpuUsageMillicores: 0,
+      cpuLimitCores: 1,
+      throttledRatio: 0,
+      memoryUsedBytes: workingSetBytes,
+      workingSetBytes: workingSetBytes,
+      memoryLimitBytes: limitBytes,
+      effectiveMemoryLimitBytes: effectiveLimitBytes,
+      cpuUtilizationQuantiles: QuantileSummary.empty,
+      throttledRatioQuantiles: QuantileSummary.empty,
+      workingSetQuantiles: QuantileSummary.empty,
+    );
+
+void main() {
+  group('MemoryBudget', () {
+    test('is a fraction of the limit minus non-cache working set', () {
+      final budget = MemoryBudget(0.5);
+      budget.update(_snapshot(workingSetBytes: 400));
+      expect(budget.bytes, equals(300));
+    });
+
+    test('prefers the effective (memory.high) limit', () {
+      final budget = MemoryBudget(0.5);
+      budget.update(_snapshot(workingSetBytes: 400, effectiveLimitBytes: 800));
+      expect(budget.bytes, equals(200));
+    });
+
+    test('does not count reported cache bytes as working set', () {
+      final budget = MemoryBudget(0.5)..reportUsage(200);
+      budget.update(_snapshot(workingSetBytes: 400));
+      expect(budget.bytes, equals(400));
+    });
+
+    test('hysteresis suppresses small changes', () async {
+      final budget = MemoryBudget(1.0, hysteresis: 0.1);
+      final published = <int>[];
+      final subscription = budget.changes.listen(published.add);
+
+      budget.update(_snapshot(workingSetBytes: 500)); // 500
+      budget.update(_snapshot(workingSetBytes: 480)); // 520, within 10%
+      budget.update(_snapshot(workingSetBytes: 800)); // 200, shrink
+      budget.update(_snapshot(workingSetBytes: 300)); // 700, grow
+      await Future<void>.delayed(Duration.zero);
+
+      expect(published, equals([500, 200, 700]));
+      expect(budget.bytes, equals(700));
+      await subscription.cancel();
+    });
+
+    test('is zero when working set exceeds the limit', () {
+      final budget = MemoryBudget(0.5);
+      budget.update(_snapshot(workingSetBytes: 1200));
+      expect(budget.bytes, equals(0));
+    });
+  });
+}
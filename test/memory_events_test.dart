@@ -0,0 +1,92 @@
+import 'dart:io';
+
+import 'package:system_resources_2/src/platform_detector.dart';
+import 'package:system_resources_2/src/resource_sampler.dart';
+import 'package:system_resources_2/system_resources_2.dart';
+import 'package:test/test.dart';
+
+import 'copy_fixture.dart';
+
+void main() {
+  tearDown(() {
+    PlatformDetector.setRoot(null);
+    SystemResources.clearState();
+  });
+
+  group('MemoryEventMonitor', () {
+    test('reads cgroup v2 memory.stat without rates on the first read', () {
+      PlatformDetector.setRoot('test/fixtures/cgroup-v2');
+      SystemResources.clearState();
+      final events = SystemResources.memoryEvents();
+
+      expect(events.hostWide, isFalse);
+      expect(events.faultsPerSecond, equals(0.0));
+      expect(events.scansPerSecond, equals(0.0));
+      expect(events.reclaimEfficiency, equals(1.0));
+    });
+
+    test('derives cgroup rates from the pgscan and pgsteal totals',
+        () async {
+      final root = copyFixture('cgroup-v2');
+      PlatformDetector.setRoot(root.path);
+      SystemResources.clearState();
+      SystemResources.memoryEvents();
+
+      final stat = File('${root.path}/sys/fs/cgroup/memory.stat');
+      stat.writeAsStringSync(stat
+          .readAsStringSync()
+          .replaceFirst('pgfault 123456', 'pgfault 133456')
+          .replaceFirst('pgscan 8000', 'pgscan 9000')
+          .replaceFirst('pgsteal 6000', 'pgsteal 6250'));
+      await Future<void>.delayed(const Duration(milliseconds: 100));
+      final events = SystemResources.memoryEvents();
+
+      expect(events.faultsPerSecond, greaterThan(0));
+      // 10000 faults and 1000 scans over the same interval.
+      expect(events.scansPerSecond,
+          closeTo(events.faultsPerSecond / 10, 1e-6));
+      expect(events.stealsPerSecond,
+          closeTo(events.scansPerSecond / 4, 1e-6));
+      expect(events.reclaimEfficiency, closeTo(0.25, 1e-9));
+      expect(events.activationsPerSecond, equals(0.0));
+    });
+
+    test('sums reclaimers from /proc/vmstat on hosts', () async {
+      final root = copyFixture('host-256cpu');
+      PlatformDetector.setRoot(root.path);
+      SystemResources.clearState();
+      expect(SystemResources.memoryEvents().hostWide, isTrue);
+
+      final vmstat = File('${root.path}/proc/vmstat');
+      vmstat.writeAsStringSync(vmstat
+          .readAsStringSync()
+          .replaceFirst('pgscan_direct 40000', 'pgscan_direct 41000')
+          .replaceFirst('pgscan_file 190000', 'pgscan_file 191000')
+          .replaceFirst('pgsteal_direct 30000', 'pgsteal_direct 30900')
+          .replaceFirst('pgsteal_file 160000', 'pgsteal_file 160900'));
+      await Future<void>.delayed(const Duration(milliseconds: 100));
+      final events = SystemResources.memoryEvents();
+
+      expect(events.scansPerSecond, greaterThan(0));
+      // pgscan_anon/pgscan_file repeat the same pages and are not added.
+      expect(events.reclaimEfficiency, closeTo(0.9, 1e-9));
+    });
+
+    test('is empty without event counters', () {
+      PlatformDetector.setRoot('test/fixtures/cgroup-v1');
+      SystemResources.clearState();
+
+      expect(SystemResources.memoryEvents().faultsPerSecond, equals(0.0));
+      expect(ResourceSampler.sample().reclaimEfficiency, equals(1.0));
+    });
+
+    test('reads this system on the live filesystem', () {
+      if (!Platform.isLinux) return;
+      SystemResources.memoryEvents();
+      final events = SystemResources.memoryEvents();
+
+      expect(events.faultsPerSecond, greaterThanOrEqualTo(0.0));
+      expect(events.reclaimEfficiency, inInclusiveRange(0.0, 1.0));
+    });
+  });
+}
@@ -0,0 +1,74 @@
+import 'dart:io';
+
+import 'package:system_resources_2/src/memory_peak.dart';
+import 'package:system_resources_2/src/platform_detector.dart';
+import 'package:system_resources_2/src/resource_sampler.dart';
+import 'package:system_resources_2/system_resources_2.dart';
+import 'package:test/test.dart';
+
+import 'copy_fixture.dart';
+
+const _mib = 1024 * 1024;
+
+void main() {
+  tearDown(() {
+    PlatformDetector.setRoot(null);
+    SystemResources.clearState();
+  });
+
+  group('MemoryPeakMonitor', () {
+    test('reports a lifetime peak only when it grew', () {
+      final root = copyFixture('cgroup-v2');
+      PlatformDetector.setRoot(root.path);
+      SystemResources.clearState();
+
+      // Nothing to compare the lifetime peak (320 MiB) against yet.
+      expect(ResourceSampler.sample().memoryPeakBytes, equals(256 * _mib));
+      File('${root.path}/sys/fs/cgroup/memory.peak')
+          .writeAsStringSync('${400 * _mib}\n');
+      expect(ResourceSampler.sample().memoryPeakBytes, equals(400 * _mib));
+      // The spike was in the previous interval, not this one.
+      expect(ResourceSampler.sample().memoryPeakBytes, equals(256 * _mib));
+    });
+
+    test('reads memory.max_usage_in_bytes on cgroup v1', () {
+      final root = copyFixture('cgroup-v1');
+      PlatformDetector.setRoot(root.path);
+      SystemResources.clearState();
+
+      expect(MemoryPeakMonitor.sample(128 * _mib), equals(128 * _mib));
+      File('${root.path}/sys/fs/cgroup/memory/memory.max_usage_in_bytes')
+          .writeAsStringSync('${224 * _mib}\n');
+      expect(MemoryPeakMonitor.sample(128 * _mib), equals(224 * _mib));
+    });
+
+    test('stops reading a peak file that does not exist', () {
+      final root = copyFixture('cgroup-v1');
+      File('${root.path}/sys/fs/cgroup/memory/memory.max_usage_in_bytes')
+          .deleteSync();
+      PlatformDetector.setRoot(root.path);
+      SystemResources.clearState();
+
+      for (var i = 0; i < 3; i++) {
+        expect(MemoryPeakMonitor.sample(128 * _mib), equals(128 * _mib));
+      }
+      final source = SystemResources.monitoringOverhead()
+          .sources['cgroup/memory.max_usage_in_bytes']!;
+      expect(source.reads, equals(1));
+      expect(source.failures, equals(1));
+    });
+
+    test('falls back to the sampled usage without a peak', () {
+      PlatformDetector.setRoot('test/fixtures/host-256cpu');
+      SystemResources.clearState();
+
+      expect(MemoryPeakMonitor.sample(42), equals(42));
+    });
+
+    test('never reports less than the sampled usage', () {
+      final snapshot = ResourceSampler.sample();
+      expect(snapshot.memoryPeakBytes,
+          greaterThanOrEqualTo(snapshot.memoryUsedBytes));
+    });
+  });
+}
@@ -0,0 +1,107 @@
+import 'dart:io';
+
+import 'package:system_resources_2/src/platform_detector.dart';
+import 'package:system_resources_2/src/resource_sampler.dart';
+import 'package:system_resources_2/system_resources_2.dart';
+import 'package:test/test.dart';
+
+import 'copy_fixture.dart';
+
+void main() {
+  tearDown(() {
+    PlatformDetector.setRoot(null);
+    SystemResources.clearState();
+  });
+
+  group('NetworkMonitor', () {
+    test('reads interfaces, sockets and tcp_mem', () {
+      PlatformDetector.setRoot('test/fixtures/cgroup-v2');
+      SystemResources.clearState();
+      final stats = SystemResources.networkStats();
+
+      expect(stats.interfaces.map((i) => i.name), equals(['eth0']));
+      // No previous read yet.
+      expect(stats.receiveBytesPerSecond, equals(0.0));
+      expect(stats.tcpRetransmitsPerSecond, equals(0.0));
+      expect(stats.tcpSocketsInUse, equals(42));
+      expect(stats.tcpOrphans, equals(1));
+      expect(stats.tcpMemoryPages, equals(4608));
+      expect(stats.tcpMemoryPressurePages, equals(122880));
+      expect(stats.tcpMemoryLimitPages, equals(184320));
+      expect(stats.tcpMemoryPressure, closeTo(4608 / 122880, 1e-9));
+    });
+
+    test('derives rates from counter deltas', () async {
+      final root = copyFixture('cgroup-v2');
+      PlatformDetector.setRoot(root.path);
+      SystemResources.clearState();
+      SystemResources.networkStats();
+
+      File('${root.path}/proc/net/dev').writeAsStringSync(
+          'Inter-| Receive | Transmit\n'
+          ' face |bytes packets errs drop|bytes packets errs drop\n'
+          '    lo: 1048576 8192 0 0 0 0 0 0 1048576 8192 0 0 0 0 0 0\n'
+          '  eth0: 115343360 88000 0 4 0 0 0 0 53477376 62000 0 1 0 0 0 0\n');
+      final snmp = File('${root.path}/proc/net/snmp');
+      snmp.writeAsStringSync(snmp
+          .readAsStringSync()
+          .replaceFirst('130000 110000 550 3', '131000 112000 650 3'));
+      await Future<void>.delayed(const Duration(milliseconds: 100));
+      final stats = SystemResources.networkStats();
+
+      final eth0 = stats.interfaces.single;
+      expect(eth0.receiveBytesPerSecond, greaterThan(0));
+      // 10 MiB received, 1 MiB sent over the same interval.
+      expect(eth0.transmitBytesPerSecond,
+          closeTo(eth0.receiveBytesPerSecond / 10, 1e-6));
+      expect(eth0.dropsPerSecond, equals(0.0));
+      expect(stats.tcpRetransmitsPerSecond, greaterThan(0));
+      expect(stats.retransmitRatio, closeTo(100 / 2000, 1e-9));
+      expect(stats.tcpInErrorsPerSecond, equals(0.0));
+    });
+
+    test('the sampler keeps its own rate state', () async {
+      final root = copyFixture('cgroup-v2');
+      PlatformDetector.setRoot(root.path);
+      SystemResources.clearState();
+      SystemResources.networkStats();
+
+      final snmp = File('${root.path}/proc/net/snmp');
+      snmp.writeAsStringSync(snmp
+          .readAsStringSync()
+          .replaceFirst('130000 110000 550 3', '131000 112000 650 3'));
+      await Future<void>.delayed(const Duration(milliseconds: 100));
+      // The sampler's first tick must not consume the caller's delta.
+      expect(ResourceSampler.sample().tcpRetransmitsPerSecond, equals(0.0));
+      expect(SystemResources.networkStats().tcpRetransmitsPerSecond,
+          greaterThan(0));
+    });
+
+    test('forgets interfaces that disappear', () async {
+      final root = copyFixture('cgroup-v2');
+      PlatformDetector.setRoot(root.path);
+      SystemResources.clearState();
+      final dev = File('${root.path}/proc/net/dev');
+      final withEth0 = dev.readAsStringSync();
+      SystemResources.networkStats();
+
+      dev.writeAsStringSync(withEth0.replaceFirst(RegExp(r'  eth0:.*\n'), ''));
+      expect(SystemResources.networkStats().interfaces, isEmpty);
+
+      // Back with more traffic: a new interface, not a delta to the old one.
+      dev.writeAsStringSync(withEth0.replaceFirst('104857600', '115343360'));
+      await Future<void>.delayed(const Duration(milliseconds: 100));
+      final eth0 = SystemResources.networkStats().interfaces.single;
+      expect(eth0.receiveBytesPerSecond, equals(0.0));
+    });
+
+    test('is empty without /proc/net', () {
+      PlatformDetector.setRoot('test/fixtures/host-256cpu');
+      SystemResources.clearState();
+      final stats = SystemResources.networkStats();
+
+      expect(stats.interfaces, isEmpty);
+      expect(stats.tcpMemoryPressure, equals(0.0));
+    });
+  });
+}
@@ -0,0 +1,72 @@
+import 'dart:io';
+
+import 'package:system_resources_2/src/platform_detector.dart';
+import 'package:system_resources_2/system_resources_2.dart';
+import 'package:test/test.dart';
+
+import 'copy_fixture.dart';
+
+void main() {
+  tearDown(() {
+    PlatformDetector.setRoot(null);
+    SystemResources.clearState();
+  });
+
+  group('NumaMonitor', () {
+    test('reads the cgroup share of each node', () {
+      PlatformDetector.setRoot('test/fixtures/cgroup-v2');
+      SystemResources.clearState();
+      final stats = SystemResources.numaStats();
+
+      expect(stats.cgroupScoped, isTrue);
+      expect(stats.nodes.map((n) => n.node), equals([0, 1]));
+      final node0 = stats.nodes.first;
+      expect(node0.anonBytes, equals(160 << 20));
+      expect(node0.fileBytes, equals(32 << 20));
+      expect(node0.totalBytes, equals(16 << 30));
+      expect(node0.usedBytes, equals(8 << 30));
+      expect(stats.imbalance, closeTo(192 / 256, 1e-9));
+      // No previous read yet.
+      expect(node0.localAllocsPerSecond, equals(0.0));
+    });
+
+    test('falls back to node-wide pages without memory.numa_stat', () {
+      final root = copyFixture('cgroup-v2');
+      File('${root.path}/sys/fs/cgroup/memory.numa_stat').deleteSync();
+      PlatformDetector.setRoot(root.path);
+      SystemResources.clearState();
+      final stats = SystemResources.numaStats();
+
+      expect(stats.cgroupScoped, isFalse);
+      expect(stats.nodes[1].anonBytes, equals(2 << 30));
+      expect(stats.nodes[1].fileBytes, equals(1 << 30));
+    });
+
+    test('derives allocation rates from numastat deltas', () async {
+      final root = copyFixture('cgroup-v2');
+      PlatformDetector.setRoot(root.path);
+      SystemResources.clearState();
+      SystemResources.numaStats();
+
+      File('${root.path}/sys/devices/system/node/node1/numastat')
+          .writeAsStringSync('numa_hit 40100000\nnuma_miss 50000\n'
+              'numa_foreign 1000\ninterleave_hit 20000\n'
+              'local_node 36075000\nother_node 4075000\n');
+      await Future<void>.delayed(const Duration(milliseconds: 100));
+      final stats = SystemResources.numaStats();
+
+      final node1 = stats.nodes[1];
+      expect(node1.localAllocsPerSecond, greaterThan(0));
+      expect(node1.remoteAllocsPerSecond,
+          closeTo(node1.localAllocsPerSecond / 3, 1e-6));
+      expect(node1.missesPerSecond, equals(0.0));
+      expect(stats.remoteAllocRatio, closeTo(0.25, 1e-9));
+    });
+
+    test('is empty without NUMA nodes', () {
+      PlatformDetector.setRoot('test/fixtures/host-256cpu');
+      SystemResources.clearState();
+      expect(SystemResources.numaStats().nodes, isEmpty);
+    });
+  });
+}
@@ -0,0 +1,134 @@
+import 'dart:io';
+
+import 'package:system_resources_2/src/platform_detector.dart';
+import 'package:system_resources_2/src/resource_sampler.dart';
+import 'package:system_resources_2/src/self_stats.dart';
+import 'package:system_resources_2/system_resources_2.dart';
+import 'package:test/test.dart';
+
+import 'copy_fixture.dart';
+
+void main() {
+  tearDown(() {
+    PlatformDetector.setRoot(null);
+    SystemResources.clearState();
+  });
+
+  group('ProcessTreeMonitor', () {
+    test('sums the process, its descendants and reaped children', () {
+      PlatformDetector.setRoot('test/fixtures/cgroup-v2');
+      SystemResources.clearState();
+      final tree = SystemResources.processTreeUsage();
+
+      // self -> 101 -> 103, self -> 102
+      expect(tree.processes, equals(4));
+      // 850 + 350 + 120 + 30 ticks of 10 ms.
+      expect(tree.cpuMicros, equals(13500000));
+      expect(tree.reapedChildrenCpuMicros, equals(2500000));
+      expect(tree.rssBytes, equals(312 * 1024 * 1024));
+      expect(tree.readBytes, equals(13 * 1024 * 1024));
+      expect(tree.writeBytes, equals(5 * 1024 * 1024));
+      // No previous read yet.
+      expect(tree.cpuMillicores, equals(0));
+      expect(tree.readBytesPerSecond, equals(0.0));
+    });
+
+    test('derives rates from counter deltas', () async {
+      final root = copyFixture('cgroup-v2');
+      PlatformDetector.setRoot(root.path);
+      SystemResources.clearState();
+      SystemResources.processTreeUsage();
+
+      final stat = File('${root.path}/proc/103/stat');
+      stat.writeAsStringSync(
+          stat.readAsStringSync().replaceFirst(' 30 0 0 0 ', ' 130 0 0 0 '));
+      final io = File('${root.path}/proc/103/io');
+      io.writeAsStringSync(io
+          .readAsStringSync()
+          .replaceFirst('read_bytes: 1048576', 'read_bytes: 2097152'));
+      await Future<void>.delayed(const Duration(milliseconds: 100));
+      final tree = SystemResources.processTreeUsage();
+
+      expect(tree.cpuMicros, equals(14500000));
+      expect(tree.cpuMillicores, greaterThan(0));
+      expect(tree.readBytesPerSecond, greaterThan(0));
+      expect(tree.writeBytesPerSecond, equals(0.0));
+    });
+
+    test('skips children that have exited', () {
+      final root = copyFixture('cgroup-v2');
+      PlatformDetector.setRoot(root.path);
+      SystemResources.clearState();
+      Directory('${root.path}/proc/102').deleteSync(recursive: true);
+
+      expect(SystemResources.processTreeUsage().processes, equals(3));
+    });
+
+    test('counts reads under a fixed set of sources', () {
+      final root = copyFixture('cgroup-v2');
+      PlatformDetector.setRoot(root.path);
+      SystemResources.clearState();
+
+      // Gives process 103 [count] children starting at pid [first].
+      void spawn(int first, int count) {
+        final pids = [for (var i = 0; i < count; i++) first + i];
+        File('${root.path}/proc/103/task/103/children')
+            .writeAsStringSync('${pids.join(' ')} ');
+        for (final pid in pids) {
+          final dir = '${root.path}/proc/$pid';
+          File('$dir/stat')
+            ..createSync(recursive: true)
+            ..writeAsStringSync('$pid (worker) S 103 1 1 0 -1 0 0 0 0 0 '
+                '1 1 0 0 20 0 1 0 100 0 0\n');
+          File('$dir/status').writeAsStringSync('VmRSS:\t  1024 kB\n');
+          File('$dir/io').writeAsStringSync('read_bytes: 0\n');
+          File('$dir/task/$pid/children').createSync(recursive: true);
+        }
+      }
+
+      spawn(200, 50);
+      expect(SystemResources.processTreeUsage().processes, equals(54));
+      final sources = SelfStats.current().sources.keys.toSet();
+      expect(
+          sources,
+          containsAll([
+            'proc/<pid>/stat',
+            'proc/<pid>/status',
+            'proc/<pid>/io',
+            'proc/<pid>/task/children',
+          ]));
+
+      // A new generation of pids adds no sources.
+      spawn(300, 100);
+      expect(SystemResources.processTreeUsage().processes, equals(104));
+      expect(SelfStats.current().sources.keys.toSet(), equals(sources));
+    });
+
+    test('is empty without /proc/self/stat', () {
+      PlatformDetector.setRoot('test/fixtures/host-256cpu');
+      SystemResources.clearState();
+
+      expect(SystemResources.processTreeUsage().processes, equals(0));
+    });
+
+    test('counts this process on the live filesystem', () {
+      if (!Platform.isLinux) return;
+      final tree = SystemResources.processTreeUsage();
+
+      expect(tree.processes, greaterThanOrEqualTo(1));
+      expect(tree.rssBytes, greaterThan(0));
+    });
+
+    test('the sampler aggregates only when asked to', () {
+      PlatformDetector.setRoot('test/fixtures/cgroup-v2');
+      SystemResources.clearState();
+      expect(ResourceSampler.sample().processTreeProcesses, equals(0));
+
+      SystemResources.startSampler(processTree: true);
+      final snapshot = ResourceSampler.sample();
+      SystemResources.stopSampler();
+      expect(snapshot.processTreeProcesses, equals(4));
+      expect(snapshot.processTreeRssBytes, equals(312 * 1024 * 1024));
+    });
+  });
+}
@@ -0,0 +1,223 @@
+import 'package:system_resources_2/src/exposition.dart';
+import 'package:system_resources_2/src/platform_detector.dart';
+import 'package:system_resources_2/src/quantile_sketch.dart';
+import 'package:system_resources_2/src/resource_sampler.dart';
+import 'package:system_resources_2/src/threshold_watcher.dart';
+import 'package:system_resources_2/system_resources_2.dart';
+import 'package:test/test.dart';
+
+void main() {
+  group('QuantileSketch', () {
+    test('quantiles are within relative accuracy', () {
+      final sketch = QuantileSketch(relativeAccuracy: 0.01);
+      for (var i = 1; i <= 1000; i++) {
+        sketch.add(i.toDouble());
+      }
+
+      expect(sketch.count, equals(1000));
+      expect(sketch.quantile(0.5), closeTo(500, 500 * 0.02));
+      expect(sketch.quantile(0.9), closeTo(900, 900 * 0.02));
+      expect(sketch.quantile(0.99), closeTo(990, 990 * 0.02));
+      expect(sketch.max, equals(1000));
+    });
+
+    test('zero and below-range values are counted', () {
+      final sketch = QuantileSketch(minValue: 1.0);
+      sketch.add(0);
+      sketch.add(0);
+      sketch.add(0.5);
+      sketch.add(10);
+
+      expect(sketch.count, equals(4));
+      expect(sketch.quantile(0.5), equals(0.0));
+      expect(sketch.quantile(1.0), equals(10.0));
+    });
+
+    test('merge combines counts', () {
+      final a = QuantileSketch();
+      final b = QuantileSketch();
+      for (var i = 1; i <= 100; i++) {
+        a.add(i.toDouble());
+        b.add((i + 100).toDouble());
+      }
+      a.merge(b);
+
+      expect(a.count, equals(200));
+      expect(a.quantile(0.5), closeTo(100, 100 * 0.02));
+      expect(a.max, equals(200));
+    });
+
+    test('merge rejects different configuration', () {
+      final a = QuantileSketch(relativeAccuracy: 0.01);
+      final b = QuantileSketch(relativeAccuracy: 0.02);
+      expect(() => a.merge(b), throwsArgumentError);
+    });
+
+    test('empty sketch summarizes to zero', () {
+      final summary = QuantileSketch().summary();
+      expect(summary.count, equals(0));
+      expect(summary.p99, equals(0.0));
+    });
+  });
+
+  group('WindowedQuantileSketch', () {
+    test('values outside the window expire', () {
+      final sketch = WindowedQuantileSketch(
+        window: const Duration(seconds: 6),
+        slots: 6,
+      );
+      const second = 1000000;
+
+      sketch.add(100, 0);
+      sketch.add(1, 3 * second);
+      expect(sketch.summary(3 * second).max, equals(100));
+
+      // 10s later, the first value is outside the 6s window
+      sketch.add(1, 10 * second);
+      final summary = sketch.summary(10 * second);
+      expect(summary.count, equals(1));
+      expect(summary.max, equals(1));
+    });
+
+    test('repeated summaries do not accumulate', () {
+      final sketch = WindowedQuantileSketch(
+        window: const Duration(seconds: 6),
+      );
+      sketch.add(5, 0);
+      sketch.add(7, 1000000);
+
+      expect(sketch.summary(1000000).count, equals(2));
+      expect(sketch.summary(1000000).count, equals(2));
+      expect(sketch.merged(1000000).count, equals(2));
+    });
+  });
+
+  group('ResourceSampler', () {
+    setUp(ResourceSampler.clearState);
+
+    test('sample produces non-negative snapshot', () {
+      ResourceSampler.sample();
+      final snapshot = ResourceSampler.sample();
+
+      expect(snapshot.cpuUtilization, greaterThanOrEqualTo(0.0));
+      expect(snapshot.throttledRatio, inInclusiveRange(0.0, 1.0));
+      expect(snapshot.workingSetBytes, greaterThanOrEqualTo(0));
+      expect(snapshot.workingSetQuantiles.count, greaterThanOrEqualTo(2));
+    });
+
+    test('quantiles are weighted by time covered', () {
+      final sketch = WindowedQuantileSketch(window: const Duration(minutes: 1));
+      // 1s at 0.9 followed by ten 100ms samples at 0.1
+      sketch.add(0.9, 1000000, 1000);
+      for (var i = 1; i <= 10; i++) {
+        sketch.add(0.1, 1000000 + i * 100000, 100);
+      }
+      final summary = sketch.summary(2000000);
+
+      expect(summary.count, equals(2000));
+      expect(summary.p90, closeTo(0.9, 0.9 * 0.02));
+    });
+
+    test('adaptive sampling stays within bounds', () {
+      ResourceSampler.start(
+        interval: const Duration(seconds: 10),
+        minInterval: const Duration(milliseconds: 100),
+        maxInterval: const Duration(seconds: 5),
+      );
+      for (var i = 0; i < 10; i++) {
+        final snapshot = ResourceSampler.sample();
+        expect(snapshot.samplingInterval.inMilliseconds,
+            inInclusiveRange(100, 5000));
+      }
+      ResourceSampler.stop();
+    });
+
+    test('rejects inverted interval bounds', () {
+      expect(
+        () => ResourceSampler.start(
+          minInterval: const Duration(seconds: 5),
+          maxInterval: const Duration(seconds: 1),
+        ),
+        throwsArgumentError,
+      );
+    });
+
+    test('exposition contains gauges and summaries', () {
+      final text = ExpositionEncoder.encode(ResourceSampler.sample());
+
+      expect(text, contains('# TYPE sysres_memory_used_bytes gauge'));
+      expect(text,
+          contains('sysres_cpu_utilization_window_ratio{quantile="0.99"}'));
+      expect(text, contains('sysres_memory_working_set_window_bytes_count'));
+    });
+  });
+
+  group('Adaptive sampling', () {
+    tearDown(() {
+      PlatformDetector.setRoot(null);
+      SystemResources.clearState();
+    });
+
+    /// Starts the sampler on [fixture] between 100ms and 8s and returns
+    /// the interval chosen after its first tick, in milliseconds.
+    int startOn(String fixture, Duration interval) {
+      PlatformDetector.setRoot('test/fixtures/$fixture');
+      SystemResources.clearState();
+      ResourceSampler.start(
+        interval: interval,
+        minInterval: const Duration(milliseconds: 100),
+        maxInterval: const Duration(seconds: 8),
+      );
+      return ResourceSampler.interval.inMilliseconds;
+    }
+
+    int tick() {
+      ResourceSampler.sample();
+      return ResourceSampler.interval.inMilliseconds;
+    }
+
+    test('halves the interval when hot', () {
+      // cpu.pressure reports some avg10=12.00, above the 5% hot level.
+      expect(startOn('cgroup-v2', const Duration(seconds: 4)), equals(2000));
+      expect([for (var i = 0; i < 5; i++) tick()],
+          equals([1000, 500, 250, 125, 100]));
+    });
+
+    test('doubles the interval when calm', () {
+      // No pressure, and the static fixture shows no CPU use or throttling.
+      expect(startOn('systemd-nested', const Duration(seconds: 1)),
+          equals(2000));
+      expect([for (var i = 0; i < 3; i++) tick()], equals([4000, 8000, 8000]));
+    });
+
+    test('changes the interval at most 2x per tick', () {
+      var previous = startOn('systemd-nested', const Duration(seconds: 1));
+      final intervals = <int>[];
+      for (var i = 0; i < 12; i++) {
+        if (i == 4) {
+          // Crossed but still dwelling: near its threshold.
+          ThresholdWatcher.add(ThresholdRule(
+            name: 'cpu-pressure-low',
+            metric: ResourceMetric.cpuPressure,
+            comparator: ThresholdComparator.below,
+            enter: 0.01,
+            dwell: const Duration(hours: 1),
+          ));
+        }
+        if (i == 8) ThresholdWatcher.remove('cpu-pressure-low');
+
+        final interval = tick();
+        expect(interval, inInclusiveRange(previous ~/ 2, previous * 2));
+        intervals.add(interval);
+        previous = interval;
+      }
+      expect(
+          intervals,
+          equals([
+            4000, 8000, 8000, 8000, // calm
+            4000, 2000, 1000, 500, // near the rule
+            1000, 2000, 4000, 8000, // calm again
+          ]));
+    });
+  });
+}
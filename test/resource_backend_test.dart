@@ -0,0 +1,59 @@
+import 'dart:io';
+
+import 'package:system_resources_2/src/platform_detector.dart';
+import 'package:system_resources_2/src/resource_backend.dart';
+import 'package:system_resources_2/system_resources_2.dart';
+import 'package:test/test.dart';
+
+void main() {
+  setUpAll(() async {
+    await SystemResources.init();
+  });
+
+  setUp(SystemResources.clearState);
+
+  group('ResourceBackend', () {
+    test('is selected once for the detected platform', () {
+      final backend = ResourceBackend.current;
+
+      expect(backend.platform, equals(PlatformDetector.detectPlatform()));
+      expect(identical(ResourceBackend.current, backend), isTrue);
+    });
+
+    test('every platform maps to a backend', () {
+      for (final platform in DetectedPlatform.values) {
+        expect(ResourceBackend.forPlatform(platform).platform,
+            equals(platform));
+      }
+    });
+
+    test('readAll agrees with the individual getters', () {
+      final backend = ResourceBackend.current;
+      final readings = backend.readAll();
+
+      expect(readings.cpuLimitCores, equals(backend.cpuLimitCores()));
+      expect(readings.memoryLimitBytes, equals(backend.memoryLimitBytes()));
+      expect(readings.workingSetBytes,
+          lessThanOrEqualTo(readings.memoryUsedBytes));
+      expect(readings.effectiveMemoryLimitBytes,
+          lessThanOrEqualTo(readings.memoryLimitBytes));
+    });
+
+    test('gVisor backend reads limits and usage from /proc', () {
+      final backend = GVisorBackend();
+      final readings = backend.readAll();
+
+      expect(readings.cpuUsageMicros, greaterThan(0));
+      expect(readings.cpuLimitCores, greaterThan(0));
+      expect(readings.memoryLimitBytes, greaterThan(0));
+      expect(readings.cpuPressure, equals(0.0));
+    }, skip: !Platform.isLinux);
+
+    test('clearState reselects the backend', () {
+      ResourceBackend.current;
+      SystemResources.clearState();
+      expect(ResourceBackend.current.platform,
+          equals(PlatformDetector.detectPlatform()));
+    });
+  });
+}
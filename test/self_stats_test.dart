@@ -0,0 +1,133 @@
+import 'dart:io';
+
+import 'package:system_resources_2/src/exposition.dart';
+import 'package:system_resources_2/src/platform_detector.dart';
+import 'package:system_resources_2/src/resource_sampler.dart';
+import 'package:system_resources_2/src/self_stats.dart';
+import 'package:system_resources_2/system_resources_2.dart';
+import 'package:test/test.dart';
+
+import 'copy_fixture.dart';
+
+void main() {
+  void useFixture(String name) {
+    PlatformDetector.setRoot('test/fixtures/$name');
+    SystemResources.clearState();
+  }
+
+  tearDown(() {
+    PlatformDetector.setRoot(null);
+    SystemResources.clearState();
+  });
+
+  group('SelfStats', () {
+    test('counts reads, bytes and system calls per source', () {
+      useFixture('cgroup-v2');
+      final snapshot = ResourceSampler.sample();
+      final overhead = snapshot.overhead;
+
+      expect(overhead.samples, equals(1));
+      expect(overhead.readsPerSample, greaterThan(0));
+      // At least open, one read, the read that hits EOF and close.
+      expect(overhead.syscallsPerSample,
+          greaterThanOrEqualTo(overhead.readsPerSample * 4));
+      expect(overhead.minSampleMicros,
+          lessThanOrEqualTo(overhead.maxSampleMicros));
+
+      final current = overhead.sources['cgroup/memory.current']!;
+      expect(current.reads, greaterThan(0));
+      expect(current.bytes, greaterThan(0));
+      expect(current.failures, equals(0));
+    });
+
+    test('counts fallbacks when a cgroup is unlimited', () {
+      useFixture('systemd-nested');
+      SystemResources.memoryLimitBytes();
+
+      final overhead = SystemResources.monitoringOverhead();
+      expect(overhead.samples, equals(0));
+      expect(overhead.sources['cgroup/memory.max']!.reads, greaterThan(0));
+      expect(overhead.sources['proc/meminfo']!.fallbacks, greaterThan(0));
+    });
+
+    test('counts failed reads and rethrows', () {
+      useFixture('cgroup-v2');
+      final path = '${PlatformDetector.root}/proc/missing';
+
+      expect(() => SelfStats.readFile(path), throwsA(anything));
+      final stats = SelfStats.current().sources['proc/missing']!;
+      expect(stats.reads, equals(1));
+      expect(stats.failures, equals(1));
+      expect(stats.bytes, equals(0));
+    });
+
+    test('counts unparsable contents as failed reads', () {
+      final root = copyFixture('cgroup-v2');
+      File('${root.path}/sys/fs/cgroup/memory.current')
+          .writeAsStringSync('garbage\n');
+      PlatformDetector.setRoot(root.path);
+      SystemResources.clearState();
+
+      expect(SystemResources.memoryUsedBytes(), equals(0));
+      final stats = SelfStats.current().sources['cgroup/memory.current']!;
+      expect(stats.reads, equals(1));
+      expect(stats.failures, equals(1));
+      expect(stats.bytes, greaterThan(0));
+    });
+
+    test('clearState resets the counters', () {
+      useFixture('cgroup-v2');
+      ResourceSampler.sample();
+      SystemResources.clearState();
+
+      final overhead = SystemResources.monitoringOverhead();
+      expect(overhead.samples, equals(0));
+      expect(overhead.sources, isEmpty);
+    });
+
+    test('is exposed in the exposition format', () {
+      useFixture('cgroup-v2');
+      final text = ExpositionEncoder.encode(ResourceSampler.sample());
+
+      expect(text, contains('sysres_self_samples_total 1\n'));
+      expect(text, contains('# TYPE sysres_self_syscalls_per_sample gauge'));
+      expect(
+          text,
+          contains('sysres_self_source_reads_total'
+              '{source="cgroup/memory.current"}'));
+    });
+
+    test('folds numbered path components into one source', () {
+      useFixture('cgroup-v2');
+      final root = PlatformDetector.root;
+
+      expect(SelfStats.sourceName('$root/proc/12345/stat'),
+          equals('proc/<n>/stat'));
+      expect(SelfStats.sourceName('$root/proc/self/task/678/children'),
+          equals('proc/self/task/<n>/children'));
+      expect(
+          SelfStats.sourceName(
+              '$root/sys/devices/system/cpu/cpu12/cpufreq/scaling_max_freq'),
+          equals('sys/devices/system/cpu/cpu<n>/cpufreq/scaling_max_freq'));
+      expect(
+          SelfStats.sourceName('$root/sys/devices/system/node/node1/meminfo'),
+          equals('sys/devices/system/node/node<n>/meminfo'));
+      // Not a numbered component.
+      expect(SelfStats.sourceName('$root/proc/sys/net/ipv4/tcp_mem'),
+          equals('proc/sys/net/ipv4/tcp_mem'));
+    });
+
+    test('caps the number of sources', () {
+      useFixture('cgroup-v2');
+      for (var i = 0; i < 2 * SelfStats.maxSources; i++) {
+        SelfStats.count('/unique/source-$i-x',
+            syscalls: 1, startMicros: SelfStats.nowMicros());
+      }
+
+      final sources = SelfStats.current().sources;
+      expect(sources.length, lessThanOrEqualTo(SelfStats.maxSources + 1));
+      expect(sources[SelfStats.overflowSource]!.reads,
+          greaterThanOrEqualTo(SelfStats.maxSources));
+    });
+  });
+}
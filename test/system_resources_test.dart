@@ -1,5 +1,6 @@
 import 'dart:io';
 
+import 'package:system_resources_2/src/ttl_cache.dart';
 import 'package:system_resources_2/system_resources_2.dart';
 import 'package:test/test.dart';
 
@@ -58,6 +59,14 @@ void main() {
       expect(() => SystemResources.cgroupVersion(), returnsNormally);
     });
 
+    test('snapshot samples on each call without a running sampler', () {
+      final first = SystemResources.snapshot();
+      final second = SystemResources.snapshot();
+
+      expect(second.timestampMicros, greaterThan(first.timestampMicros));
+      expect(second.overhead.samples, equals(first.overhead.samples + 1));
+    });
+
     test('multiple calls return consistent results', () {
       // Initialize delta tracking
       SystemResources.cpuLoad();
@@ -203,4 +212,33 @@ void main() {
       }
     }, skip: !Platform.isMacOS ? 'Only runs on macOS' : null);
   });
+
+  group('Coalesced reads', () {
+    test('TtlCache reads at most once per window', () {
+      final cache = TtlCache<int>();
+      var reads = 0;
+      int reader() => ++reads;
+
+      expect(cache.get(60000000, reader), equals(1));
+      expect(cache.get(60000000, reader), equals(1));
+      expect(reads, equals(1));
+
+      // maxStalenessMicros of 0 always reads
+      expect(cache.get(0, reader), equals(2));
+
+      cache.clear();
+      expect(cache.get(60000000, reader), equals(3));
+    });
+
+    test('getters return the cached value within the window', () {
+      const window = 60000000;
+      final used = SystemResources.memoryUsedBytes(maxStalenessMicros: window);
+      for (var i = 0; i < 10; i++) {
+        expect(SystemResources.memoryUsedBytes(maxStalenessMicros: window),
+            equals(used));
+      }
+      expect(SystemResources.memUsage(maxStalenessMicros: window),
+          greaterThanOrEqualTo(0.0));
+    });
+  });
 }
@@ -0,0 +1,101 @@
+import 'package:system_resources_2/src/quantile_sketch.dart';
+import 'package:system_resources_2/src/resource_sampler.dart';
+import 'package:system_resources_2/src/threshold_watcher.dart';
+import 'package:test/test.dart';
+
+const _second = 1000000;
+
+ResourceSnapshot _snapshot(int seconds, double memoryUsage) =>
+    ResourceSnapshot(
+      timestampMicros: seconds * _second,
+      cpuUtilization: 0,
+      cpuUsageMillicores: 0,
+      cpuLimitCores: 1,
+      throttledRatio: 0,
+      memoryUsedBytes: (memoryUsage * 1000).round(),
+      workingSetBytes: (memoryUsage * 1000).round(),
+      memoryLimitBytes: 1000,
+      cpuUtilizationQuantiles: QuantileSummary.empty,
+      throttledRatioQuantiles: QuantileSummary.empty,
+      workingSetQuantiles: QuantileSummary.empty,
+    );
+
+void main() {
+  group('ThresholdWatcher', () {
+    final events = <ThresholdEvent>[];
+
+    setUp(() {
+      ThresholdWatcher.clearState();
+      events.clear();
+      ThresholdWatcher.add(ThresholdRule(
+        name: 'memory-high',
+        metric: ResourceMetric.memoryUsage,
+        comparator: ThresholdComparator.above,
+        enter: 0.85,
+        exit: 0.75,
+        dwell: const Duration(seconds: 5),
+      ));
+    });
+
+    Future<void> feed(List<double> values) async {
+      final subscription = ThresholdWatcher.events.listen(events.add);
+      for (var i = 0; i < values.length; i++) {
+        ThresholdWatcher.evaluate(_snapshot(i, values[i]));
+      }
+      await Future<void>.delayed(Duration.zero);
+      await subscription.cancel();
+    }
+
+    test('enters only after dwell time', () async {
+      await feed([0.9, 0.9, 0.9, 0.9, 0.9, 0.9]);
+
+      expect(events, hasLength(1));
+      expect(events.single.active, isTrue);
+      expect(events.single.timestampMicros, equals(5 * _second));
+      expect(ThresholdWatcher.isActive('memory-high'), isTrue);
+    });
+
+    test('short spikes do not fire', () async {
+      await feed([0.9, 0.9, 0.5, 0.9, 0.9, 0.5]);
+
+      expect(events, isEmpty);
+      expect(ThresholdWatcher.isActive('memory-high'), isFalse);
+    });
+
+    test('clears only below exit threshold', () async {
+      await feed([
+        for (var i = 0; i < 6; i++) 0.9, // enter
+        for (var i = 0; i < 6; i++) 0.8, // between exit and enter
+        for (var i = 0; i < 6; i++) 0.7, // below exit
+      ]);
+
+      expect(events.map((e) => e.active), equals([true, false]));
+      expect(events.last.timestampMicros, equals(17 * _second));
+    });
+
+    test('an active rule far past its threshold is not near', () async {
+      expect(ThresholdWatcher.isNear(_snapshot(0, 0.5)), isFalse);
+      expect(ThresholdWatcher.isNear(_snapshot(0, 0.8)), isTrue);
+
+      await feed([0.9, 0.9, 0.9, 0.9, 0.9, 0.9]);
+      expect(ThresholdWatcher.isActive('memory-high'), isTrue);
+      // Sustained alert: no reason to keep sampling fast.
+      expect(ThresholdWatcher.isNear(_snapshot(6, 0.99)), isFalse);
+      // Back toward the exit threshold: it may clear soon.
+      expect(ThresholdWatcher.isNear(_snapshot(6, 0.8)), isTrue);
+    });
+
+    test('rejects inverted hysteresis', () {
+      expect(
+        () => ThresholdRule(
+          name: 'bad',
+          metric: ResourceMetric.cpuUtilization,
+          comparator: ThresholdComparator.above,
+          enter: 0.5,
+          exit: 0.9,
+        ),
+        throwsArgumentError,
+      );
+    });
+  });
+}
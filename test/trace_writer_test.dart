@@ -0,0 +1,95 @@
+import 'dart:convert';
+import 'dart:developer';
+import 'dart:io';
+
+import 'package:system_resources_2/src/quantile_sketch.dart';
+import 'package:system_resources_2/src/resource_sampler.dart';
+import 'package:system_resources_2/src/trace_writer.dart';
+import 'package:test/test.dart';
+
+ResourceSnapshot _snapshot({double cpuUtilization = 0.5}) => ResourceSnapshot(
+      timestampMicros: ResourceSampler.nowMicros(),
+      cpuUtilization: cpuUtilization,
+      cpuUsageMillicores: 500,
+      cpuLimitCores: 1,
+      throttledRatio: 0,
+      memoryUsedBytes: 1000,
+      workingSetBytes: 800,
+      memoryLimitBytes: 2000,
+      cpuUtilizationQuantiles: QuantileSummary.empty,
+      throttledRatioQuantiles: QuantileSummary.empty,
+      workingSetQuantiles: QuantileSummary.empty,
+    );
+
+List<Map<String, dynamic>> _events(String path) =>
+    (jsonDecode(File(path).readAsStringSync()) as List)
+        .cast<Map<String, dynamic>>();
+
+void main() {
+  late Directory dir;
+  late String path;
+
+  setUp(() {
+    dir = Directory.systemTemp.createTempSync('sysres_trace');
+    path = '${dir.path}/trace.json';
+  });
+
+  tearDown(() => dir.deleteSync(recursive: true));
+
+  group('TraceWriter', () {
+    test('writes counter events on the timeline clock', () async {
+      final writer = TraceWriter(path);
+      final before = Timeline.now;
+      writer.write(_snapshot());
+      writer.write(_snapshot());
+      await writer.close();
+
+      final events = _events(path);
+      expect(events, hasLength(42));
+      expect(events.every((e) => e['ph'] == 'C' && e['pid'] == pid), isTrue);
+      final cpu =
+          events.firstWhere((e) => e['name'] == 'cpu_usage_millicores');
+      expect(cpu['args'], equals({'value': 500}));
+      expect(cpu['ts'], closeTo(before, 1000000));
+    });
+
+    test('an unfinished file only lacks the closing bracket', () async {
+      final writer = TraceWriter(path)..write(_snapshot());
+      // As left behind by a crash: viewers accept it, jsonDecode does not.
+      final content = File(path).readAsStringSync();
+      expect(jsonDecode('$content]') as List, hasLength(21));
+      await writer.close();
+    });
+
+    test('skips non-finite values', () async {
+      final writer = TraceWriter(path)
+        ..write(_snapshot(cpuUtilization: double.nan));
+      await writer.close();
+
+      final names = _events(path).map((e) => e['name']);
+      expect(names, isNot(contains('cpu_utilization_ratio')));
+      expect(names, contains('cpu_usage_millicores'));
+    });
+
+    test('rotates and keeps maxFiles older files', () async {
+      final writer = TraceWriter(path, maxBytes: 4096, maxFiles: 2);
+      for (var i = 0; i < 20; i++) {
+        writer.write(_snapshot());
+      }
+      await writer.close();
+
+      expect(File('$path.1').existsSync(), isTrue);
+      expect(File('$path.2').existsSync(), isTrue);
+      expect(File('$path.3').existsSync(), isFalse);
+      for (final file in [path, '$path.1', '$path.2']) {
+        expect(File(file).lengthSync(), lessThanOrEqualTo(4096 + 3));
+        expect(_events(file), isNotEmpty);
+      }
+    });
+
+    test('validates arguments', () {
+      expect(() => TraceWriter(path, maxBytes: 100), throwsArgumentError);
+      expect(() => TraceWriter(path, maxFiles: -1), throwsArgumentError);
+    });
+  });
+}